@@ -0,0 +1,705 @@
+#include "bnb_backend.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fcntl.h>
+#include <math.h>
+#include <set>
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+const double kFeasibilityTolerance = 1e-6;
+const double kIntegralityTolerance = 1e-6;
+const long kNodeIterationLimit = 1000000;
+
+// Starts gzip writing to filename and returns a stream to its input, or NULL
+// if the file cannot be created or gzip cannot be started. gzip is run
+// without a shell, so the file name is never interpreted.
+FILE *OpenGzipPipe(const char *filename, pid_t *pid) {
+  int output = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (output < 0) return NULL;
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) {
+    close(output);
+    return NULL;
+  }
+  *pid = fork();
+  if (*pid == 0) {
+    dup2(pipe_fds[0], STDIN_FILENO);
+    dup2(output, STDOUT_FILENO);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+    close(output);
+    execlp("gzip", "gzip", "-c", static_cast<char *>(NULL));
+    _exit(127);
+  }
+  close(pipe_fds[0]);
+  close(output);
+  FILE *file = *pid > 0 ? fdopen(pipe_fds[1], "w") : NULL;
+  if (!file) {
+    close(pipe_fds[1]);
+    if (*pid > 0) waitpid(*pid, NULL, 0);
+  }
+  return file;
+}
+
+// Closes a stream returned by OpenGzipPipe(). Returns true if gzip has
+// written all of it, i.e., exited with status 0.
+bool CloseGzipPipe(FILE *file, pid_t pid) {
+  bool is_closed = fclose(file) == 0;
+  int status;
+  if (waitpid(pid, &status, 0) != pid) return false;
+  return is_closed && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Sorts the terms of a row by variable, merges duplicates and drops zeros.
+void NormalizeTerms(std::vector<std::pair<int, double> > *terms) {
+  std::sort(terms->begin(), terms->end());
+  int size = 0;
+  for (int i = 0; i < terms->size(); ++i) {
+    if (size > 0 && terms->at(size - 1).first == terms->at(i).first) {
+      terms->at(size - 1).second += terms->at(i).second;
+    } else {
+      terms->at(size++) = terms->at(i);
+    }
+  }
+  terms->resize(size);
+  terms->erase(std::remove_if(terms->begin(), terms->end(),
+                              [](const std::pair<int, double> &term) {
+                                return term.second == 0.0;
+                              }),
+               terms->end());
+}
+
+bool IsSatisfied(double lhs, ConstraintSense sense, double rhs) {
+  double tolerance = kFeasibilityTolerance * std::max(1.0, fabs(rhs));
+  switch (sense) {
+    case kLessEqual:
+      return lhs <= rhs + tolerance;
+    case kGreaterEqual:
+      return lhs >= rhs - tolerance;
+    default:
+      return fabs(lhs - rhs) <= tolerance;
+  }
+}
+
+void WriteLPExpr(FILE *file, const LinearExpr &expr) {
+  int count = 0;
+  for (auto &term : expr.terms) {
+    fprintf(file, " %c %.12g x%d", term.second < 0 ? '-' : '+',
+            fabs(term.second), term.first);
+    if (++count % 8 == 0) fprintf(file, "\n  ");
+  }
+  if (expr.terms.empty()) fprintf(file, " 0 x0");
+}
+
+void WriteLPConstraint(FILE *file, const LinearConstraint &constraint) {
+  WriteLPExpr(file, constraint.expr);
+  const char *sense = constraint.sense == kLessEqual
+                          ? "<="
+                          : (constraint.sense == kGreaterEqual ? ">=" : "=");
+  fprintf(file, " %s %.12g\n", sense,
+          constraint.rhs - constraint.expr.constant);
+}
+}  // namespace
+
+BranchAndBoundBackend::BranchAndBoundBackend()
+    : objective_constant_(0.0),
+      cutoff_(MIP_INFINITY),
+      rollback_variables_(0),
+      rollback_constraints_(0),
+      rollback_indicators_(0),
+      rollback_lazy_constraints_(0),
+      status_("Unknown"),
+      objective_value_(0.0),
+      first_incumbent_time_(-1.0),
+      root_bound_(-MIP_INFINITY),
+      num_nodes_(0) {}
+
+int BranchAndBoundBackend::AddVariable(double lb, double ub,
+                                       VariableType type) {
+  if (type == kBinary) {
+    lb = std::max(lb, 0.0);
+    ub = std::min(ub, 1.0);
+  }
+  lb_.push_back(lb);
+  ub_.push_back(ub);
+  type_.push_back(type);
+  priority_.push_back(0);
+  objective_.push_back(0.0);
+  return lb_.size() - 1;
+}
+
+int BranchAndBoundBackend::AddConstraint(const LinearConstraint &constraint) {
+  constraints_.push_back(constraint);
+  return constraints_.size() - 1;
+}
+
+void BranchAndBoundBackend::AddIndicatorConstraint(
+    int variable, int value, const LinearConstraint &constraint) {
+  IndicatorConstraint indicator;
+  indicator.variable = variable;
+  indicator.value = value;
+  indicator.constraint = constraint;
+  indicators_.push_back(indicator);
+}
+
+void BranchAndBoundBackend::SetObjective(const LinearExpr &objective) {
+  std::fill(objective_.begin(), objective_.end(), 0.0);
+  for (auto &term : objective.terms) objective_[term.first] += term.second;
+  objective_constant_ = objective.constant;
+}
+
+void BranchAndBoundBackend::SetRollBackPoint() {
+  rollback_variables_ = lb_.size();
+  rollback_constraints_ = constraints_.size();
+  rollback_indicators_ = indicators_.size();
+  rollback_lazy_constraints_ = lazy_constraints_.size();
+}
+
+void BranchAndBoundBackend::RollBack() {
+  int num_variables = rollback_variables_;
+  lb_.resize(num_variables);
+  ub_.resize(num_variables);
+  type_.resize(num_variables);
+  priority_.resize(num_variables);
+  objective_.assign(num_variables, 0.0);
+  objective_constant_ = 0.0;
+  constraints_.resize(rollback_constraints_);
+  indicators_.resize(rollback_indicators_);
+  lazy_constraints_.resize(rollback_lazy_constraints_);
+  for (auto &constraint : constraints_) {
+    auto &terms = constraint.expr.terms;
+    terms.erase(std::remove_if(terms.begin(), terms.end(),
+                               [num_variables](
+                                   const std::pair<int, double> &term) {
+                                 return term.first >= num_variables;
+                               }),
+                terms.end());
+  }
+  mip_start_.clear();
+  cutoff_ = MIP_INFINITY;
+}
+
+bool BranchAndBoundBackend::ExportModel(const char *filename) {
+  // Compressed models are streamed through gzip instead of being written to
+  // disk first. If gzip fails, writes to the pipe fail instead of raising
+  // SIGPIPE.
+  int length = strlen(filename);
+  bool compress = length > 3 && !strcmp(filename + length - 3, ".gz");
+  pid_t gzip_pid = -1;
+  struct sigaction ignore, previous;
+  memset(&ignore, 0, sizeof(ignore));
+  ignore.sa_handler = SIG_IGN;
+  if (compress) sigaction(SIGPIPE, &ignore, &previous);
+  FILE *file =
+      compress ? OpenGzipPipe(filename, &gzip_pid) : fopen(filename, "w");
+  if (!file) {
+    if (compress) sigaction(SIGPIPE, &previous, NULL);
+    return false;
+  }
+  fprintf(file, "\\Problem exported by the bnb backend\n");
+  fprintf(file, "\\Objective constant = %.12g\n", objective_constant_);
+  fprintf(file, "Minimize\n obj:");
+  LinearExpr objective;
+  for (int i = 0; i < objective_.size(); ++i) {
+    if (objective_[i] != 0.0) objective.AddTerm(i, objective_[i]);
+  }
+  WriteLPExpr(file, objective);
+  fprintf(file, "\nSubject To\n");
+  for (int i = 0; i < constraints_.size(); ++i) {
+    fprintf(file, " c%d:", i);
+    WriteLPConstraint(file, constraints_[i]);
+  }
+  for (int i = 0; i < indicators_.size(); ++i) {
+    fprintf(file, " i%d: x%d = %d ->", i, indicators_[i].variable,
+            indicators_[i].value);
+    WriteLPConstraint(file, indicators_[i].constraint);
+  }
+  if (!lazy_constraints_.empty()) fprintf(file, "Lazy Constraints\n");
+  for (int i = 0; i < lazy_constraints_.size(); ++i) {
+    fprintf(file, " l%d:", i);
+    WriteLPConstraint(file, lazy_constraints_[i]);
+  }
+  fprintf(file, "Bounds\n");
+  for (int i = 0; i < lb_.size(); ++i) {
+    if (lb_[i] <= -MIP_INFINITY) {
+      fprintf(file, " -infinity <= x%d", i);
+    } else {
+      fprintf(file, " %.12g <= x%d", lb_[i], i);
+    }
+    if (ub_[i] >= MIP_INFINITY) {
+      fprintf(file, " <= +infinity\n");
+    } else {
+      fprintf(file, " <= %.12g\n", ub_[i]);
+    }
+  }
+  fprintf(file, "Binaries\n");
+  for (int i = 0; i < type_.size(); ++i) {
+    if (type_[i] == kBinary) fprintf(file, " x%d\n", i);
+  }
+  fprintf(file, "Generals\n");
+  for (int i = 0; i < type_.size(); ++i) {
+    if (type_[i] == kInteger) fprintf(file, " x%d\n", i);
+  }
+  fprintf(file, "End\n");
+  bool is_written = !ferror(file);
+  if (!compress) return fclose(file) == 0 && is_written;
+  is_written = CloseGzipPipe(file, gzip_pid) && is_written;
+  sigaction(SIGPIPE, &previous, NULL);
+  return is_written;
+}
+
+void BranchAndBoundBackend::LinearizeIndicator(
+    const IndicatorConstraint &indicator, std::vector<SimplexRow> *rows) {
+  // Both senses are handled as expr <= rhs; expr >= rhs becomes
+  // -expr <= -rhs and an equality yields one row of each kind.
+  auto &constraint = indicator.constraint;
+  for (int sign = 1; sign >= -1; sign -= 2) {
+    if (constraint.sense == (sign > 0 ? kGreaterEqual : kLessEqual)) continue;
+    SimplexRow row;
+    row.sense = kLessEqual;
+    row.rhs = sign * (constraint.rhs - constraint.expr.constant);
+    double max_activity = 0.0;
+    for (auto &term : constraint.expr.terms) {
+      double coefficient = sign * term.second;
+      row.terms.push_back(std::make_pair(term.first, coefficient));
+      double bound = coefficient > 0 ? ub_[term.first] : lb_[term.first];
+      if (fabs(bound) >= MIP_INFINITY) bound = DualSimplex::kArtificialBound;
+      max_activity += coefficient * bound;
+    }
+    // The row may be violated by at most big_m when the indicator is off.
+    double big_m = max_activity - row.rhs;
+    if (big_m <= kFeasibilityTolerance) continue;
+    if (indicator.value == 1) {
+      // expr <= rhs + M (1 - z).
+      row.terms.push_back(std::make_pair(indicator.variable, big_m));
+      row.rhs += big_m;
+    } else {
+      // expr <= rhs + M z.
+      row.terms.push_back(std::make_pair(indicator.variable, -big_m));
+    }
+    rows->push_back(row);
+  }
+}
+
+bool BranchAndBoundBackend::Presolve(std::vector<SimplexRow> *rows) {
+  std::vector<SimplexRow> all_rows;
+  for (auto &constraint : constraints_) {
+    SimplexRow row;
+    row.terms = constraint.expr.terms;
+    row.sense = constraint.sense;
+    row.rhs = constraint.rhs - constraint.expr.constant;
+    all_rows.push_back(row);
+  }
+  for (auto &indicator : indicators_) LinearizeIndicator(indicator, &all_rows);
+  for (auto &row : all_rows) NormalizeTerms(&row.terms);
+
+  std::vector<double> lb = lb_, ub = ub_;
+  std::vector<bool> removed(all_rows.size(), false);
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (int i = 0; i < all_rows.size(); ++i) {
+      if (removed[i]) continue;
+      auto &row = all_rows[i];
+      // Substitute fixed variables.
+      int size = 0;
+      for (auto &term : row.terms) {
+        if (lb[term.first] == ub[term.first]) {
+          row.rhs -= term.second * lb[term.first];
+        } else {
+          row.terms[size++] = term;
+        }
+      }
+      row.terms.resize(size);
+      if (row.terms.empty()) {
+        if (!IsSatisfied(0.0, row.sense, row.rhs)) return false;
+        removed[i] = true;
+        continue;
+      }
+      if (row.terms.size() > 1) continue;
+      // A single variable: a * x (<=, >=, ==) rhs becomes a bound.
+      int var = row.terms[0].first;
+      double a = row.terms[0].second;
+      double bound = row.rhs / a;
+      bool upper = row.sense == kEqual || (row.sense == kLessEqual) == (a > 0);
+      bool lower =
+          row.sense == kEqual || (row.sense == kGreaterEqual) == (a > 0);
+      if (type_[var] != kContinuous) {
+        if (upper) bound = floor(bound + kIntegralityTolerance);
+        if (lower && !upper) bound = ceil(bound - kIntegralityTolerance);
+      }
+      if (upper && bound < ub[var]) ub[var] = bound;
+      if (lower && bound > lb[var]) lb[var] = bound;
+      if (lb[var] > ub[var] + kFeasibilityTolerance) return false;
+      if (lb[var] > ub[var]) ub[var] = lb[var];
+      removed[i] = true;
+      changed = true;
+    }
+  }
+
+  // Drop duplicate rows.
+  std::set<std::vector<double> > seen;
+  rows->clear();
+  for (int i = 0; i < all_rows.size(); ++i) {
+    if (removed[i]) continue;
+    std::vector<double> key;
+    key.push_back(all_rows[i].sense);
+    key.push_back(all_rows[i].rhs);
+    for (auto &term : all_rows[i].terms) {
+      key.push_back(term.first);
+      key.push_back(term.second);
+    }
+    if (!seen.insert(key).second) continue;
+    rows->push_back(all_rows[i]);
+  }
+
+  // Number the remaining columns.
+  column_of_.assign(lb_.size(), -1);
+  variable_of_.clear();
+  fixed_value_ = lb;
+  column_lb_.clear();
+  column_ub_.clear();
+  for (int var = 0; var < lb_.size(); ++var) {
+    if (lb[var] == ub[var]) continue;
+    column_of_[var] = variable_of_.size();
+    variable_of_.push_back(var);
+    column_lb_.push_back(lb[var]);
+    column_ub_.push_back(ub[var]);
+  }
+  for (auto &row : *rows) {
+    for (auto &term : row.terms) term.first = column_of_[term.first];
+  }
+  return true;
+}
+
+bool BranchAndBoundBackend::IsFeasible(
+    const std::vector<double> &values) const {
+  for (int var = 0; var < values.size(); ++var) {
+    if (values[var] < lb_[var] - kFeasibilityTolerance ||
+        values[var] > ub_[var] + kFeasibilityTolerance) {
+      return false;
+    }
+  }
+  for (auto *constraints : {&constraints_, &lazy_constraints_}) {
+    for (auto &constraint : *constraints) {
+      double lhs = constraint.expr.constant;
+      for (auto &term : constraint.expr.terms) {
+        lhs += term.second * values[term.first];
+      }
+      if (!IsSatisfied(lhs, constraint.sense, constraint.rhs)) return false;
+    }
+  }
+  for (auto &indicator : indicators_) {
+    if (fabs(values[indicator.variable] - indicator.value) > 0.5) continue;
+    auto &constraint = indicator.constraint;
+    double lhs = constraint.expr.constant;
+    for (auto &term : constraint.expr.terms) {
+      lhs += term.second * values[term.first];
+    }
+    if (!IsSatisfied(lhs, constraint.sense, constraint.rhs)) return false;
+  }
+  return true;
+}
+
+bool BranchAndBoundBackend::AddViolatedLazyConstraints(
+    const std::vector<double> &values) {
+  std::vector<SimplexRow> rows;
+  for (int i = 0; i < lazy_constraints_.size(); ++i) {
+    auto &constraint = lazy_constraints_[i];
+    if (is_lazy_in_lp_[i]) continue;
+    double lhs = constraint.expr.constant;
+    for (auto &term : constraint.expr.terms) {
+      lhs += term.second * values[term.first];
+    }
+    if (IsSatisfied(lhs, constraint.sense, constraint.rhs)) continue;
+    // The row is presolved like the others: fixed variables are substituted
+    // and the remaining ones are replaced by their columns.
+    SimplexRow row;
+    row.sense = constraint.sense;
+    row.rhs = constraint.rhs - constraint.expr.constant;
+    for (auto &term : constraint.expr.terms) {
+      int column = column_of_[term.first];
+      if (column < 0) {
+        row.rhs -= term.second * fixed_value_[term.first];
+      } else {
+        row.terms.push_back(std::make_pair(column, term.second));
+      }
+    }
+    NormalizeTerms(&row.terms);
+    rows.push_back(row);
+    is_lazy_in_lp_[i] = true;
+  }
+  if (rows.empty()) return false;
+  DEBUG("bnb: node %ld, %d lazy constraints added\n", num_nodes_,
+        static_cast<int>(rows.size()));
+  lp_.AddRows(rows);
+  return true;
+}
+
+bool BranchAndBoundBackend::CompleteMIPStart(
+    std::vector<double> *values) const {
+  if (mip_start_.empty()) return false;
+  values->resize(lb_.size());
+  for (int var = 0; var < lb_.size(); ++var) {
+    values->at(var) = std::min(std::max(0.0, lb_[var]), ub_[var]);
+  }
+  for (auto &value : mip_start_) values->at(value.first) = value.second;
+  return IsFeasible(*values);
+}
+
+bool BranchAndBoundBackend::Solve() {
+  num_nodes_ = 0;
+  first_incumbent_time_ = -1.0;
+  root_bound_ = -MIP_INFINITY;
+  solution_.assign(lb_.size(), 0.0);
+  std::vector<SimplexRow> rows;
+  if (!Presolve(&rows)) {
+    status_ = "Infeasible";
+    return false;
+  }
+  DEBUG("bnb presolve: %d rows, %d columns\n", static_cast<int>(rows.size()),
+        static_cast<int>(variable_of_.size()));
+  std::vector<double> cost(variable_of_.size());
+  for (int column = 0; column < variable_of_.size(); ++column) {
+    cost[column] = objective_[variable_of_[column]];
+  }
+  try {
+    lp_.Load(cost, column_lb_, column_ub_, rows);
+  }
+  catch (std::bad_alloc &e) {
+    printf("bnb backend: not enough memory for a %dx%d tableau\n",
+           static_cast<int>(rows.size()),
+           static_cast<int>(rows.size() + variable_of_.size()));
+    status_ = "Error";
+    return false;
+  }
+  is_lazy_in_lp_.assign(lazy_constraints_.size(), false);
+  RunBranchAndBound();
+  return status_ == "Optimal" || status_ == "Feasible";
+}
+
+bool BranchAndBoundBackend::SolveRelaxation(std::vector<double> *values,
+                                            std::vector<double> *duals) {
+  // Rows are not presolved, so that every constraint keeps its row and
+  // thereby its dual. The LP of the search is left untouched.
+  std::vector<SimplexRow> rows(constraints_.size());
+  for (int i = 0; i < constraints_.size(); ++i) {
+    rows[i].terms = constraints_[i].expr.terms;
+    NormalizeTerms(&rows[i].terms);
+    rows[i].sense = constraints_[i].sense;
+    rows[i].rhs = constraints_[i].rhs - constraints_[i].expr.constant;
+  }
+  DualSimplex lp;
+  try {
+    lp.Load(objective_, lb_, ub_, rows);
+  }
+  catch (std::bad_alloc &e) {
+    printf("bnb backend: not enough memory for a %dx%d tableau\n",
+           static_cast<int>(rows.size()),
+           static_cast<int>(rows.size() + lb_.size()));
+    return false;
+  }
+  if (lp.Solve(MIP_INFINITY, kNodeIterationLimit) != DualSimplex::kOptimal) {
+    return false;
+  }
+  values->resize(lb_.size());
+  for (int var = 0; var < lb_.size(); ++var) (*values)[var] = lp.value(var);
+  lp.GetDuals(duals);
+  return true;
+}
+
+void BranchAndBoundBackend::RunBranchAndBound() {
+  auto start_time = std::chrono::steady_clock::now();
+  struct BoundChange {
+    int column;
+    double lb, ub;
+  };
+  struct Node {
+    std::vector<BoundChange> changes;
+    // Objective of the parent's LP relaxation, a lower bound for the node.
+    double bound;
+    // Number of the parent node and its optimal basis. Unless the parent's
+    // LP has been solved last, re-optimizing starts from that basis; the
+    // basis left behind by an unrelated, possibly infeasible, node may be
+    // arbitrarily far away.
+    long parent;
+    std::vector<int> basis;
+  };
+
+  // Objective contribution of the fixed variables.
+  double constant = objective_constant_;
+  for (int var = 0; var < lb_.size(); ++var) {
+    if (column_of_[var] < 0) constant += objective_[var] * fixed_value_[var];
+  }
+  // If the objective can only take integer values, an improving solution has
+  // to be better by at least one.
+  bool integral_objective = fabs(constant - round(constant)) < 1e-9;
+  for (int var = 0; var < lb_.size() && integral_objective; ++var) {
+    if (objective_[var] == 0.0 || column_of_[var] < 0) continue;
+    if (type_[var] == kContinuous ||
+        fabs(objective_[var] - round(objective_[var])) > 1e-9) {
+      integral_objective = false;
+    }
+  }
+
+  double incumbent = MIP_INFINITY;
+  double cutoff = MIP_INFINITY;
+  // Only solutions better than the incumbent are explored further.
+  auto set_incumbent = [&](const std::vector<double> &values, double value) {
+    incumbent = value;
+    solution_ = values;
+    cutoff = integral_objective
+                 ? value - 1.0 + kFeasibilityTolerance
+                 : value - kFeasibilityTolerance * std::max(1.0, fabs(value));
+    // Nodes that cannot improve on the incumbent by more than the gap are
+    // pruned as well.
+    if (parameters_.mip_gap > 0.0) {
+      cutoff = std::min(cutoff, value - parameters_.mip_gap * fabs(value));
+    }
+    if (first_incumbent_time_ < 0) {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_time;
+      first_incumbent_time_ = elapsed.count();
+    }
+  };
+  // A user cutoff keeps solutions of exactly that value, unlike the cutoff
+  // derived from an incumbent.
+  if (cutoff_ < MIP_INFINITY) {
+    cutoff = cutoff_ + kFeasibilityTolerance * std::max(1.0, fabs(cutoff_));
+  }
+  bool complete = true;
+  std::vector<double> candidate(lb_.size());
+  if (CompleteMIPStart(&candidate)) {
+    double value = objective_constant_;
+    for (int var = 0; var < lb_.size(); ++var) {
+      value += objective_[var] * candidate[var];
+    }
+    DEBUG("bnb: MIP start accepted with objective %lf\n", value);
+    if (value < cutoff) set_incumbent(candidate, value);
+  } else if (!mip_start_.empty()) {
+    DEBUG("bnb: MIP start rejected as infeasible\n");
+  }
+  std::vector<int> changed_columns;
+  std::vector<Node> stack(1);
+  stack[0].bound = -MIP_INFINITY;
+  stack[0].parent = 0;
+  while (!stack.empty()) {
+    if (parameters_.time_limit > 0.0) {
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start_time;
+      if (elapsed.count() >= parameters_.time_limit) {
+        DEBUG("bnb: time limit reached after %ld nodes\n", num_nodes_);
+        complete = false;
+        break;
+      }
+    }
+    Node node = stack.back();
+    stack.pop_back();
+    if (node.bound >= cutoff) continue;
+
+    // Move the LP from the bounds of the previous node to this node's.
+    for (int column : changed_columns) {
+      lp_.SetBounds(column, column_lb_[column], column_ub_[column]);
+    }
+    changed_columns.clear();
+    for (auto &change : node.changes) {
+      lp_.SetBounds(change.column, change.lb, change.ub);
+      changed_columns.push_back(change.column);
+    }
+    if (node.parent != num_nodes_) lp_.SetBasis(node.basis);
+
+    ++num_nodes_;
+    DualSimplex::Status lp_status =
+        lp_.Solve(cutoff - constant, kNodeIterationLimit);
+    if (lp_status == DualSimplex::kIterationLimit) complete = false;
+    if (lp_status != DualSimplex::kOptimal) continue;
+    double lp_objective = lp_.objective_lower_bound() + constant;
+    // The root is solved again after lazy constraints have been added.
+    if (node.changes.empty()) root_bound_ = lp_objective;
+    if (lp_objective >= cutoff) continue;
+
+    // Branch on the most fractional integer column among those with the
+    // highest priority.
+    int branch_column = -1;
+    int max_priority = 0;
+    double max_fractionality = 0.0;
+    for (int column = 0; column < lp_.num_columns(); ++column) {
+      int var = variable_of_[column];
+      if (type_[var] == kContinuous) continue;
+      double value = lp_.value(column);
+      double fractionality = fabs(value - round(value));
+      if (fractionality <= kIntegralityTolerance) continue;
+      if (branch_column < 0 || priority_[var] > max_priority ||
+          (priority_[var] == max_priority &&
+           fractionality > max_fractionality)) {
+        max_priority = priority_[var];
+        max_fractionality = fractionality;
+        branch_column = column;
+      }
+    }
+    if (branch_column < 0) {
+      for (int var = 0; var < lb_.size(); ++var) {
+        int column = column_of_[var];
+        double value = column < 0 ? fixed_value_[var] : lp_.value(column);
+        if (type_[var] != kContinuous) value = round(value);
+        candidate[var] = value;
+      }
+      // Solve the node again, starting from the current basis, with the
+      // lazy constraints it violates.
+      if (AddViolatedLazyConstraints(candidate)) {
+        node.bound = lp_objective;
+        node.parent = num_nodes_;
+        stack.push_back(node);
+        continue;
+      }
+      if (!IsFeasible(candidate)) {
+        DEBUG("bnb: rejected numerically infeasible solution\n");
+        continue;
+      }
+      double value = objective_constant_;
+      for (int var = 0; var < lb_.size(); ++var) {
+        value += objective_[var] * candidate[var];
+      }
+      if (value < incumbent) {
+        DEBUG("bnb: node %ld, new incumbent %lf\n", num_nodes_, value);
+        set_incumbent(candidate, value);
+      }
+      continue;
+    }
+
+    // Explore the child closer to the LP value first.
+    double value = lp_.value(branch_column);
+    Node down, up;
+    down.changes = up.changes = node.changes;
+    down.bound = up.bound = lp_objective;
+    down.parent = up.parent = num_nodes_;
+    down.basis = up.basis = lp_.basis();
+    BoundChange down_change = {branch_column, lp_.lb(branch_column),
+                               floor(value)};
+    BoundChange up_change = {branch_column, ceil(value),
+                             lp_.ub(branch_column)};
+    down.changes.push_back(down_change);
+    up.changes.push_back(up_change);
+    if (value - floor(value) < 0.5) {
+      stack.push_back(up);
+      stack.push_back(down);
+    } else {
+      stack.push_back(down);
+      stack.push_back(up);
+    }
+  }
+
+  objective_value_ = incumbent;
+  if (incumbent < MIP_INFINITY) {
+    status_ = complete ? "Optimal" : "Feasible";
+  } else {
+    status_ = complete ? "Infeasible" : "Unknown";
+  }
+}
@@ -0,0 +1,136 @@
+#ifndef BNB_BACKEND_H_
+#define BNB_BACKEND_H_
+
+#include "dual_simplex.h"
+#include "mip_backend.h"
+
+#include <string>
+#include <vector>
+
+// In-tree MIPBackend that does not depend on any external solver. The model
+// is solved by depth-first, LP-based branch-and-bound; LP relaxations are
+// solved by DualSimplex and re-optimized from the parent's basis after every
+// branching decision. Indicator constraints are linearized with big-M
+// coefficients computed from variable bounds. Lazy constraints are left out
+// of the relaxations until an integral solution violates them; they are then
+// added to the LP and the node is solved again. The dense tableau limits the
+// backend to small and medium sized instances.
+class BranchAndBoundBackend : public MIPBackend {
+ public:
+  BranchAndBoundBackend();
+
+  const char *name() const { return "bnb"; }
+  int AddVariable(double lb, double ub, VariableType type);
+  int AddConstraint(const LinearConstraint &constraint);
+  void SetCoefficient(int constraint, int variable, double coefficient) {
+    constraints_[constraint].expr.AddTerm(variable, coefficient);
+  }
+  void SetRHS(int constraint, double rhs) {
+    constraints_[constraint].rhs = rhs;
+  }
+  void SetBounds(int variable, double lb, double ub) {
+    lb_[variable] = lb;
+    ub_[variable] = ub;
+  }
+  void AddIndicatorConstraint(int variable, int value,
+                              const LinearConstraint &constraint);
+  void AddLazyConstraint(const LinearConstraint &constraint) {
+    lazy_constraints_.push_back(constraint);
+  }
+  void SetObjective(const LinearExpr &objective);
+  void SetPriority(int variable, int priority) {
+    priority_[variable] = priority;
+  }
+  void SetMIPStart(const std::vector<std::pair<int, double> > &values) {
+    mip_start_ = values;
+  }
+  void SetCutoff(double cutoff) { cutoff_ = cutoff; }
+  void SetRollBackPoint();
+  void RollBack();
+  // Only the time limit and the MIP gap are supported; the search is
+  // sequential and keeps its tree in memory.
+  void SetParameters(const MIPParameters &parameters) {
+    parameters_ = parameters;
+  }
+  bool ExportModel(const char *filename);
+  bool Solve();
+  bool SolveRelaxation(std::vector<double> *values,
+                       std::vector<double> *duals);
+  std::string GetStatus() { return status_; }
+  double GetValue(int variable) { return solution_[variable]; }
+  void GetValues(std::vector<double> *values) { *values = solution_; }
+  double GetObjValue() { return objective_value_; }
+  double GetFirstIncumbentTime() { return first_incumbent_time_; }
+  double GetRootBound() { return root_bound_; }
+  long GetNodeCount() { return num_nodes_; }
+  int num_variables() const { return lb_.size(); }
+  int num_constraints() const {
+    return constraints_.size() + indicators_.size();
+  }
+  int num_lazy_constraints() const { return lazy_constraints_.size(); }
+
+ private:
+  struct IndicatorConstraint {
+    int variable;
+    int value;
+    LinearConstraint constraint;
+  };
+
+  // Converts the model into the rows and column bounds of the LP relaxation:
+  // indicator constraints are linearized, rows with a single variable become
+  // bounds, duplicate rows are dropped and fixed variables are substituted.
+  // Returns false if the model is found to be infeasible.
+  bool Presolve(std::vector<SimplexRow> *rows);
+  // Appends the big-M linearization of an indicator constraint to rows.
+  void LinearizeIndicator(const IndicatorConstraint &indicator,
+                          std::vector<SimplexRow> *rows);
+  // Returns true if values satisfies all constraints of the model, including
+  // the lazy ones.
+  bool IsFeasible(const std::vector<double> &values) const;
+  // Adds the lazy constraints that values violates to the LP. Returns false
+  // if there are none.
+  bool AddViolatedLazyConstraints(const std::vector<double> &values);
+  // Turns the MIP start into a complete assignment; variables without a
+  // value are set to the value closest to 0 within their bounds. Returns
+  // false if there is no start or it is infeasible.
+  bool CompleteMIPStart(std::vector<double> *values) const;
+  void RunBranchAndBound();
+
+  // Model.
+  std::vector<double> lb_, ub_, objective_;
+  std::vector<VariableType> type_;
+  std::vector<int> priority_;
+  double objective_constant_;
+  std::vector<LinearConstraint> constraints_;
+  std::vector<IndicatorConstraint> indicators_;
+  std::vector<LinearConstraint> lazy_constraints_;
+  std::vector<std::pair<int, double> > mip_start_;
+  double cutoff_;
+  // Number of variables, constraints, indicator and lazy constraints at the
+  // last call to SetRollBackPoint().
+  int rollback_variables_;
+  int rollback_constraints_;
+  int rollback_indicators_;
+  int rollback_lazy_constraints_;
+  MIPParameters parameters_;
+
+  // Presolved problem. column_of_[var] is the LP column of a variable, or -1
+  // if the variable has been fixed to fixed_value_[var].
+  std::vector<int> column_of_;
+  std::vector<int> variable_of_;
+  std::vector<double> fixed_value_;
+  std::vector<double> column_lb_, column_ub_;
+  DualSimplex lp_;
+  // Whether each lazy constraint has been added to the LP.
+  std::vector<bool> is_lazy_in_lp_;
+
+  // Solution.
+  std::string status_;
+  std::vector<double> solution_;
+  double objective_value_;
+  double first_incumbent_time_;
+  double root_bound_;
+  long num_nodes_;
+};
+
+#endif  // BNB_BACKEND_H_
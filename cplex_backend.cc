@@ -0,0 +1,355 @@
+#include "cplex_backend.h"
+
+#include <algorithm>
+#include <sstream>
+
+namespace {
+// Records the CPLEX time at which the first incumbent becomes available and
+// the last bound seen while the root node is processed. Informational
+// callbacks do not change the search strategy.
+class SearchInfoCallback : public IloCplex::MIPInfoCallbackI {
+ public:
+  SearchInfoCallback(IloEnv env, double *first_incumbent_cplex_time,
+                     double *root_bound)
+      : IloCplex::MIPInfoCallbackI(env),
+        first_incumbent_cplex_time_(first_incumbent_cplex_time),
+        root_bound_(root_bound) {}
+
+  IloCplex::CallbackI *duplicateCallback() const {
+    return new (getEnv()) SearchInfoCallback(*this);
+  }
+
+ protected:
+  void main() {
+    if (*first_incumbent_cplex_time_ < 0 && hasIncumbent()) {
+      *first_incumbent_cplex_time_ = getCplexTime();
+    }
+    if (getNnodes() == 0) *root_bound_ = getBestObjValue();
+  }
+
+ private:
+  double *first_incumbent_cplex_time_;
+  double *root_bound_;
+};
+}  // namespace
+
+CPLEXBackend::CPLEXBackend() {
+  model_ = IloModel(env_);
+  cplex_ = IloCplex(model_);
+  variables_ = IloNumVarArray(env_);
+  ranges_ = IloRangeArray(env_);
+  indicators_ = IloConstraintArray(env_);
+  constraints_ = IloConstraintArray(env_);
+  num_constraints_ = 0;
+  lazy_ranges_ = IloRangeArray(env_);
+  lazy_constraints_ = IloConstraintArray(env_);
+  has_objective_ = false;
+  rollback_variables_ = rollback_ranges_ = rollback_indicators_ = 0;
+  rollback_lazy_ranges_ = 0;
+  first_incumbent_time_ = -1.0;
+  root_bound_ = -MIP_INFINITY;
+  cplex_.use(IloCplex::Callback(new (env_) SearchInfoCallback(
+      env_, &first_incumbent_cplex_time_, &root_bound_)));
+}
+
+CPLEXBackend::~CPLEXBackend() { env_.end(); }
+
+int CPLEXBackend::AddVariable(double lb, double ub, VariableType type) {
+  if (lb <= -MIP_INFINITY) lb = -IloInfinity;
+  if (ub >= MIP_INFINITY) ub = IloInfinity;
+  switch (type) {
+    case kContinuous:
+      variables_.add(IloNumVar(env_, lb, ub, ILOFLOAT));
+      break;
+    case kInteger:
+      variables_.add(IloNumVar(env_, lb, ub, ILOINT));
+      break;
+    case kBinary:
+      variables_.add(IloNumVar(env_, lb, ub, ILOBOOL));
+      break;
+  }
+  return variables_.getSize() - 1;
+}
+
+IloExpr CPLEXBackend::ToIloExpr(const LinearExpr &expr) {
+  IloExpr ilo_expr(env_);
+  for (auto &term : expr.terms) {
+    ilo_expr += term.second * variables_[term.first];
+  }
+  ilo_expr += expr.constant;
+  return ilo_expr;
+}
+
+IloRange CPLEXBackend::ToIloRange(const LinearConstraint &constraint) {
+  IloExpr expr = ToIloExpr(constraint.expr);
+  switch (constraint.sense) {
+    case kLessEqual:
+      return expr <= constraint.rhs;
+    case kGreaterEqual:
+      return expr >= constraint.rhs;
+    default:
+      return expr == constraint.rhs;
+  }
+}
+
+int CPLEXBackend::AddConstraint(const LinearConstraint &constraint) {
+  IloRange range = ToIloRange(constraint);
+  ranges_.add(range);
+  senses_.push_back(constraint.sense);
+  constraints_.add(range);
+  ++num_constraints_;
+  return ranges_.getSize() - 1;
+}
+
+void CPLEXBackend::SetCoefficient(int constraint, int variable,
+                                  double coefficient) {
+  ranges_[constraint].setLinearCoef(variables_[variable], coefficient);
+}
+
+void CPLEXBackend::SetRHS(int constraint, double rhs) {
+  switch (senses_[constraint]) {
+    case kLessEqual:
+      ranges_[constraint].setUB(rhs);
+      break;
+    case kGreaterEqual:
+      ranges_[constraint].setLB(rhs);
+      break;
+    default:
+      ranges_[constraint].setBounds(rhs, rhs);
+  }
+}
+
+void CPLEXBackend::SetBounds(int variable, double lb, double ub) {
+  if (lb <= -MIP_INFINITY) lb = -IloInfinity;
+  if (ub >= MIP_INFINITY) ub = IloInfinity;
+  variables_[variable].setBounds(lb, ub);
+}
+
+void CPLEXBackend::AddIndicatorConstraint(int variable, int value,
+                                          const LinearConstraint &constraint) {
+  IloConstraint indicator = IloIfThen(env_, variables_[variable] == value,
+                                      ToIloRange(constraint));
+  indicators_.add(indicator);
+  constraints_.add(indicator);
+  ++num_constraints_;
+}
+
+void CPLEXBackend::AddLazyConstraint(const LinearConstraint &constraint) {
+  IloRange range = ToIloRange(constraint);
+  lazy_ranges_.add(range);
+  lazy_constraints_.add(range);
+}
+
+void CPLEXBackend::SetObjective(const LinearExpr &objective) {
+  IloExpr expr = ToIloExpr(objective);
+  if (has_objective_) {
+    objective_.setExpr(expr);
+  } else {
+    objective_ = IloMinimize(env_, expr);
+    model_.add(objective_);
+    has_objective_ = true;
+  }
+  expr.end();
+}
+
+void CPLEXBackend::SetPriority(int variable, int priority) {
+  priorities_.push_back(std::make_pair(variable, priority));
+}
+
+void CPLEXBackend::SetMIPStart(
+    const std::vector<std::pair<int, double> > &values) {
+  mip_start_ = values;
+}
+
+void CPLEXBackend::SetCutoff(double cutoff) {
+  cplex_.setParam(IloCplex::CutUp, cutoff);
+}
+
+void CPLEXBackend::SetRollBackPoint() {
+  rollback_variables_ = variables_.getSize();
+  rollback_ranges_ = ranges_.getSize();
+  rollback_indicators_ = indicators_.getSize();
+  rollback_lazy_ranges_ = lazy_ranges_.getSize();
+}
+
+void CPLEXBackend::RollBack() {
+  // Ending an extractable removes it from the model, and a variable from the
+  // constraints and the objective it occurs in.
+  ExtractPendingConstraints();
+  for (int i = rollback_indicators_; i < indicators_.getSize(); ++i) {
+    indicators_[i].end();
+  }
+  indicators_.remove(rollback_indicators_,
+                     indicators_.getSize() - rollback_indicators_);
+  for (int i = rollback_ranges_; i < ranges_.getSize(); ++i) {
+    ranges_[i].end();
+  }
+  ranges_.remove(rollback_ranges_, ranges_.getSize() - rollback_ranges_);
+  // The lazy constraint pool can only be cleared as a whole; the constraints
+  // before the rollback point are added again.
+  if (lazy_ranges_.getSize() > rollback_lazy_ranges_) {
+    cplex_.clearLazyConstraints();
+    for (int i = rollback_lazy_ranges_; i < lazy_ranges_.getSize(); ++i) {
+      lazy_ranges_[i].end();
+    }
+    lazy_ranges_.remove(rollback_lazy_ranges_,
+                        lazy_ranges_.getSize() - rollback_lazy_ranges_);
+    for (int i = 0; i < lazy_ranges_.getSize(); ++i) {
+      lazy_constraints_.add(lazy_ranges_[i]);
+    }
+  }
+  senses_.resize(rollback_ranges_);
+  for (int i = rollback_variables_; i < variables_.getSize(); ++i) {
+    variables_[i].end();
+  }
+  variables_.remove(rollback_variables_,
+                    variables_.getSize() - rollback_variables_);
+  num_constraints_ = rollback_ranges_ + rollback_indicators_;
+  priorities_.erase(
+      std::remove_if(priorities_.begin(), priorities_.end(),
+                     [this](const std::pair<int, int> &priority) {
+                       return priority.first >= rollback_variables_;
+                     }),
+      priorities_.end());
+  if (has_objective_) SetObjective(LinearExpr());
+  mip_start_.clear();
+  if (cplex_.getNMIPStarts() > 0) {
+    cplex_.deleteMIPStarts(0, cplex_.getNMIPStarts());
+  }
+  cplex_.setParam(IloCplex::CutUp, IloInfinity);
+}
+
+void CPLEXBackend::SetParameters(const MIPParameters &parameters) {
+  cplex_.setParam(IloCplex::Threads, parameters.threads);
+  cplex_.setParam(IloCplex::ParallelMode, parameters.parallel_mode);
+  if (parameters.time_limit > 0.0) {
+    cplex_.setParam(IloCplex::TiLim, parameters.time_limit);
+  }
+  if (parameters.mip_gap >= 0.0) {
+    cplex_.setParam(IloCplex::EpGap, parameters.mip_gap);
+  }
+  if (parameters.node_file >= 0) {
+    cplex_.setParam(IloCplex::NodeFileInd, parameters.node_file);
+  }
+  if (parameters.tree_memory_limit > 0.0) {
+    cplex_.setParam(IloCplex::TreLim, parameters.tree_memory_limit);
+  }
+  if (parameters.work_memory > 0.0) {
+    cplex_.setParam(IloCplex::WorkMem, parameters.work_memory);
+  }
+}
+
+void CPLEXBackend::ExtractPendingConstraints() {
+  if (constraints_.getSize() > 0) {
+    model_.add(constraints_);
+    constraints_ = IloConstraintArray(env_);
+  }
+  if (lazy_constraints_.getSize() > 0) {
+    cplex_.addLazyConstraints(lazy_constraints_);
+    lazy_constraints_ = IloConstraintArray(env_);
+  }
+}
+
+bool CPLEXBackend::ExportModel(const char *filename) {
+  try {
+    ExtractPendingConstraints();
+    cplex_.exportModel(filename);
+  }
+  catch (IloException &e) {
+    printf("Exception thrown: %s\n", e.getMessage());
+    return false;
+  }
+  return true;
+}
+
+bool CPLEXBackend::Solve() {
+  try {
+    ExtractPendingConstraints();
+    for (auto &priority : priorities_) {
+      cplex_.setPriority(variables_[priority.first], priority.second);
+    }
+    if (!mip_start_.empty()) {
+      IloNumVarArray start_variables(env_);
+      IloNumArray start_values(env_);
+      for (auto &value : mip_start_) {
+        start_variables.add(variables_[value.first]);
+        start_values.add(value.second);
+      }
+      cplex_.addMIPStart(start_variables, start_values);
+      start_variables.end();
+      start_values.end();
+    }
+    first_incumbent_cplex_time_ = -1.0;
+    root_bound_ = -MIP_INFINITY;
+    double start_time = cplex_.getCplexTime();
+    bool is_success = cplex_.solve();
+    if (first_incumbent_cplex_time_ >= 0) {
+      first_incumbent_time_ = first_incumbent_cplex_time_ - start_time;
+    }
+    return is_success;
+  }
+  catch (IloException &e) {
+    printf("Exception thrown: %s\n", e.getMessage());
+  }
+  return false;
+}
+
+bool CPLEXBackend::SolveRelaxation(std::vector<double> *values,
+                                   std::vector<double> *duals) {
+  // The relaxation is a separate model on the same variables, which leaves
+  // the model and the settings of the MIP unchanged.
+  bool is_success = false;
+  try {
+    ExtractPendingConstraints();
+    IloModel relaxation(env_);
+    IloConversion conversion(env_, variables_, ILOFLOAT);
+    relaxation.add(model_);
+    relaxation.add(conversion);
+    IloCplex lp(relaxation);
+    lp.setOut(env_.getNullStream());
+    if (lp.solve() && lp.getStatus() == IloAlgorithm::Optimal) {
+      IloNumArray solution(env_);
+      lp.getValues(solution, variables_);
+      values->resize(solution.getSize());
+      for (int i = 0; i < solution.getSize(); ++i) {
+        (*values)[i] = solution[i];
+      }
+      lp.getDuals(solution, ranges_);
+      duals->resize(solution.getSize());
+      for (int i = 0; i < solution.getSize(); ++i) {
+        (*duals)[i] = solution[i];
+      }
+      solution.end();
+      is_success = true;
+    }
+    lp.end();
+    conversion.end();
+    relaxation.end();
+  }
+  catch (IloException &e) {
+    printf("Exception thrown: %s\n", e.getMessage());
+  }
+  return is_success;
+}
+
+std::string CPLEXBackend::GetStatus() {
+  std::ostringstream status;
+  status << cplex_.getStatus();
+  return status.str();
+}
+
+double CPLEXBackend::GetValue(int variable) {
+  return cplex_.getValue(variables_[variable]);
+}
+
+void CPLEXBackend::GetValues(std::vector<double> *values) {
+  IloNumArray solution(env_);
+  cplex_.getValues(solution, variables_);
+  values->resize(solution.getSize());
+  for (int i = 0; i < solution.getSize(); ++i) (*values)[i] = solution[i];
+  solution.end();
+}
+
+double CPLEXBackend::GetObjValue() { return cplex_.getObjValue(); }
+
+long CPLEXBackend::GetNodeCount() { return cplex_.getNnodes(); }
@@ -0,0 +1,90 @@
+#ifndef CPLEX_BACKEND_H_
+#define CPLEX_BACKEND_H_
+
+#include "mip_backend.h"
+
+#include <ilcplex/ilocplex.h>
+
+// MIPBackend implementation on top of the IBM ILOG CPLEX Concert API.
+class CPLEXBackend : public MIPBackend {
+ public:
+  CPLEXBackend();
+  ~CPLEXBackend();
+
+  const char *name() const { return "cplex"; }
+  int AddVariable(double lb, double ub, VariableType type);
+  int AddConstraint(const LinearConstraint &constraint);
+  void SetCoefficient(int constraint, int variable, double coefficient);
+  void SetRHS(int constraint, double rhs);
+  void SetBounds(int variable, double lb, double ub);
+  void AddIndicatorConstraint(int variable, int value,
+                              const LinearConstraint &constraint);
+  void AddLazyConstraint(const LinearConstraint &constraint);
+  void SetObjective(const LinearExpr &objective);
+  void SetPriority(int variable, int priority);
+  void SetMIPStart(const std::vector<std::pair<int, double> > &values);
+  void SetCutoff(double cutoff);
+  void SetRollBackPoint();
+  void RollBack();
+  void SetParameters(const MIPParameters &parameters);
+  bool ExportModel(const char *filename);
+  bool Solve();
+  bool SolveRelaxation(std::vector<double> *values,
+                       std::vector<double> *duals);
+  std::string GetStatus();
+  double GetValue(int variable);
+  void GetValues(std::vector<double> *values);
+  double GetObjValue();
+  double GetFirstIncumbentTime() { return first_incumbent_time_; }
+  double GetRootBound() { return root_bound_; }
+  long GetNodeCount();
+  int num_variables() const { return variables_.getSize(); }
+  int num_constraints() const { return num_constraints_; }
+  int num_lazy_constraints() const { return lazy_ranges_.getSize(); }
+
+  IloEnv &env() { return env_; }
+  IloModel &model() { return model_; }
+  IloCplex &cplex() { return cplex_; }
+
+ private:
+  IloExpr ToIloExpr(const LinearExpr &expr);
+  IloRange ToIloRange(const LinearConstraint &constraint);
+  // Adds the constraints buffered in constraints_ to the model and those in
+  // lazy_constraints_ to the lazy constraint pool.
+  void ExtractPendingConstraints();
+
+  IloEnv env_;
+  IloModel model_;
+  IloCplex cplex_;
+  IloNumVarArray variables_;
+  // Linear constraints by id and their senses, and indicator constraints.
+  IloRangeArray ranges_;
+  std::vector<ConstraintSense> senses_;
+  IloConstraintArray indicators_;
+  // Constraints added since the last call to ExtractPendingConstraints().
+  IloConstraintArray constraints_;
+  int num_constraints_;
+  // Lazy constraints, and those added since the last call to
+  // ExtractPendingConstraints().
+  IloRangeArray lazy_ranges_;
+  IloConstraintArray lazy_constraints_;
+  IloObjective objective_;
+  bool has_objective_;
+  // Number of variables, linear, indicator and lazy constraints at the last
+  // call to SetRollBackPoint().
+  int rollback_variables_;
+  int rollback_ranges_;
+  int rollback_indicators_;
+  int rollback_lazy_ranges_;
+  // Branching priorities and MIP start, passed to CPLEX once the variables
+  // are extracted.
+  std::vector<std::pair<int, int> > priorities_;
+  std::vector<std::pair<int, double> > mip_start_;
+  // CPLEX time at which the first incumbent was found and the root bound,
+  // set by a MIP info callback.
+  double first_incumbent_cplex_time_;
+  double first_incumbent_time_;
+  double root_bound_;
+};
+
+#endif  // CPLEX_BACKEND_H_
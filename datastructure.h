@@ -1,6 +1,7 @@
 #ifndef DATASTRUCTURE_H_
 #define DATASTRUCTURE_H_
 
+#include <algorithm>
 #include <list>
 #include <string>
 #include <sstream>
@@ -9,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <stdlib.h>
+#include <unordered_map>
 
 #define INF 99999999
 #define MAXN 1000
@@ -23,12 +25,16 @@ struct edge_endpoint {
   long residual_bandwidth;
   int delay;
   int cost;
+  // Position of the reverse direction of the edge in the adjacency list of
+  // node_id.
+  int reverse_index;
   edge_endpoint(int node_id, long bw, int delay, int cost)
       : node_id(node_id),
         bandwidth(bw),
         delay(delay),
         residual_bandwidth(bw),
-        cost(cost) {}
+        cost(cost),
+        reverse_index(NIL) {}
   std::string GetDebugString() {
     return "ndoe_id = " + std::to_string(node_id) + ", bandwidth = " +
            std::to_string(bandwidth) + ", delay = " + std::to_string(delay) +
@@ -36,12 +42,49 @@ struct edge_endpoint {
   }
 };
 
+// Embedding of a virtual network and its shadow network onto a physical
+// network. Virtual links are identified by their endpoints (m, n) with m > n
+// and are mapped to a path of directed physical links from the host of m to
+// the host of n.
+struct VNEmbedding {
+  typedef std::map<std::pair<int, int>, std::vector<std::pair<int, int> > >
+      EdgeMap;
+  // Solution status in the vocabulary of IloAlgorithm::Status, e.g.,
+  // "Optimal", or "Successful" for solutions found by a heuristic.
+  std::string status;
+  double cost;
+  // Physical node hosting each virtual node and its shadow node.
+  std::vector<int> node_map;
+  std::vector<int> shadow_node_map;
+  EdgeMap edge_map;
+  EdgeMap shadow_edge_map;
+  VNEmbedding() : cost(0.0) {}
+};
+
 class Graph {
  public:
   Graph() {
     adj_list_ = std::unique_ptr<std::vector<std::vector<edge_endpoint> > >(
         new std::vector<std::vector<edge_endpoint> >);
     node_count_ = edge_count_ = 0;
+    is_indexed_ = false;
+  }
+
+  Graph(const Graph &graph)
+      : adj_list_(new std::vector<std::vector<edge_endpoint> >(
+            *graph.adj_list_)),
+        edge_index_(graph.edge_index_),
+        node_count_(graph.node_count_),
+        edge_count_(graph.edge_count_),
+        is_indexed_(graph.is_indexed_) {}
+
+  // Makes room for degree[u] edges at every node u, e.g., before adding a
+  // known set of links.
+  void reserve(const std::vector<int> &degree) {
+    if (adj_list_->size() < degree.size()) adj_list_->resize(degree.size());
+    for (int u = 0; u < degree.size(); ++u) {
+      adj_list_->at(u).reserve(degree[u]);
+    }
   }
 
   // Accessor methods.
@@ -55,15 +98,171 @@ class Graph {
   // u and v are 0-based identifiers of an edge endpoint. An edge is
   // bi-directional, i.e., calling Graph::add_edge with u = 1, v = 3 will add
   // both (1, 3) and (3, 1) in the graph.
-  int add_edge(int u, int v, long bw, int delay, int cost) {
+  void add_edge(int u, int v, long bw, int delay, int cost) {
     if (adj_list_->size() < u + 1) adj_list_->resize(u + 1);
     if (adj_list_->size() < v + 1) adj_list_->resize(v + 1);
     adj_list_->at(u).push_back(edge_endpoint(v, bw, delay, cost));
     adj_list_->at(v).push_back(edge_endpoint(u, bw, delay, cost));
+    int uv = adj_list_->at(u).size() - 1, vu = adj_list_->at(v).size() - 1;
+    adj_list_->at(u)[uv].reverse_index = vu;
+    adj_list_->at(v)[vu].reverse_index = uv;
+    // Once built, the edge index is kept up to date. Loading a topology leaves
+    // it to the first lookup, which indexes all links at once.
+    if (is_indexed_) {
+      edge_index_[EdgeKey(u, v)] = uv;
+      edge_index_[EdgeKey(v, u)] = vu;
+    }
     ++edge_count_;
     node_count_ = adj_list_->size();
   }
 
+  // Returns the position of v in the adjacency list of u, or NIL if (u, v) is
+  // not an edge.
+  int edge_index(int u, int v) const {
+    if (!is_indexed_) BuildEdgeIndex();
+    auto it = edge_index_.find(EdgeKey(u, v));
+    return it == edge_index_.end() ? NIL : it->second;
+  }
+
+  // Bandwidth of edge (u, v), which must exist.
+  long bandwidth(int u, int v) const {
+    return adj_list_->at(u)[edge_index(u, v)].bandwidth;
+  }
+
+  // Reserves bandwidth on both directions of every link of path, given as
+  // (u, v) pairs, in O(path length). Returns false and leaves the residual
+  // bandwidth unchanged if a link is missing or has too little bandwidth.
+  bool ReservePath(const std::vector<std::pair<int, int> > &path,
+                   long bandwidth) {
+    for (int i = 0; i < path.size(); ++i) {
+      int uv = edge_index(path[i].first, path[i].second);
+      if (uv == NIL ||
+          adj_list_->at(path[i].first)[uv].residual_bandwidth < bandwidth) {
+        ReleasePath(std::vector<std::pair<int, int> >(path.begin(),
+                                                      path.begin() + i),
+                    bandwidth);
+        return false;
+      }
+      AddResidualBandwidth(path[i].first, uv, -bandwidth);
+    }
+    return true;
+  }
+
+  // Undoes ReservePath(path, bandwidth).
+  void ReleasePath(const std::vector<std::pair<int, int> > &path,
+                   long bandwidth) {
+    for (auto &link : path) {
+      AddResidualBandwidth(link.first, edge_index(link.first, link.second),
+                           bandwidth);
+    }
+  }
+
+  // Reserves the bandwidth of the working and shadow paths of every virtual
+  // link of embedding, an embedding of virt_topology. Either everything or,
+  // if false is returned, nothing is reserved.
+  bool ReserveEmbedding(const Graph &virt_topology,
+                        const VNEmbedding &embedding) {
+    std::vector<std::pair<const std::vector<std::pair<int, int> > *, long> >
+        reserved;
+    for (int pass = 0; pass < 2; ++pass) {
+      auto &edge_map = pass == 0 ? embedding.edge_map
+                                 : embedding.shadow_edge_map;
+      for (auto &entry : edge_map) {
+        long bandwidth = virt_topology.bandwidth(entry.first.first,
+                                                 entry.first.second);
+        if (!ReservePath(entry.second, bandwidth)) {
+          for (auto &path : reserved) ReleasePath(*path.first, path.second);
+          return false;
+        }
+        reserved.push_back(std::make_pair(&entry.second, bandwidth));
+      }
+    }
+    return true;
+  }
+
+  // Undoes ReserveEmbedding(virt_topology, embedding).
+  void ReleaseEmbedding(const Graph &virt_topology,
+                        const VNEmbedding &embedding) {
+    for (int pass = 0; pass < 2; ++pass) {
+      auto &edge_map = pass == 0 ? embedding.edge_map
+                                 : embedding.shadow_edge_map;
+      for (auto &entry : edge_map) {
+        ReleasePath(entry.second, virt_topology.bandwidth(entry.first.first,
+                                                          entry.first.second));
+      }
+    }
+  }
+
+  // Splits the links with a residual bandwidth of at least min_bandwidth
+  // into biconnected components. (*component)[u][i] is set to the component
+  // of the i-th edge of u, or NIL if its residual bandwidth is too low.
+  // Returns the number of components.
+  int GetBiconnectedComponents(
+      long min_bandwidth, std::vector<std::vector<int> > *component) const {
+    component->resize(node_count_);
+    for (int u = 0; u < node_count_; ++u) {
+      component->at(u).assign(adj_list_->at(u).size(), NIL);
+    }
+    // Iterative version of Tarjan's algorithm: depth-first search with the
+    // position of the next edge to explore per node on the stack, and a stack
+    // of tree and back edges that is popped into a component whenever a node
+    // turns out to separate its subtree from the rest of the graph.
+    std::vector<int> discovery(node_count_, NIL), low(node_count_, 0);
+    std::vector<std::pair<int, int> > dfs_stack, edge_stack;
+    int time = 0, component_count = 0;
+    for (int root = 0; root < node_count_; ++root) {
+      if (discovery[root] != NIL) continue;
+      discovery[root] = low[root] = time++;
+      dfs_stack.push_back(std::make_pair(root, 0));
+      while (!dfs_stack.empty()) {
+        int u = dfs_stack.back().first;
+        int i = dfs_stack.back().second++;
+        auto &u_neighbors = adj_list_->at(u);
+        if (i < u_neighbors.size()) {
+          auto &end_point = u_neighbors[i];
+          int v = end_point.node_id;
+          if (end_point.residual_bandwidth < min_bandwidth) continue;
+          // Skip the tree edge u was reached by. Back edges are pushed from
+          // their lower end only.
+          if (dfs_stack.size() > 1 &&
+              v == dfs_stack[dfs_stack.size() - 2].first &&
+              end_point.reverse_index ==
+                  dfs_stack[dfs_stack.size() - 2].second - 1) {
+            continue;
+          }
+          if (discovery[v] == NIL) {
+            edge_stack.push_back(std::make_pair(u, i));
+            discovery[v] = low[v] = time++;
+            dfs_stack.push_back(std::make_pair(v, 0));
+          } else if (discovery[v] < discovery[u]) {
+            edge_stack.push_back(std::make_pair(u, i));
+            low[u] = std::min(low[u], discovery[v]);
+          }
+          continue;
+        }
+        dfs_stack.pop_back();
+        if (dfs_stack.empty()) break;
+        int parent = dfs_stack.back().first;
+        low[parent] = std::min(low[parent], low[u]);
+        if (low[u] < discovery[parent]) continue;
+        // parent separates the subtree of u: everything pushed since the
+        // tree edge (parent, u) forms a component.
+        int parent_edge = dfs_stack.back().second - 1;
+        while (true) {
+          auto edge = edge_stack.back();
+          edge_stack.pop_back();
+          auto &end_point = adj_list_->at(edge.first)[edge.second];
+          component->at(edge.first)[edge.second] = component_count;
+          component->at(end_point.node_id)[end_point.reverse_index] =
+              component_count;
+          if (edge.first == parent && edge.second == parent_edge) break;
+        }
+        ++component_count;
+      }
+    }
+    return component_count;
+  }
+
   std::string GetDebugString() {
     std::string ret_string = "node_count = " + std::to_string(node_count_);
     ret_string += ", edge_count = " + std::to_string(edge_count_) + "\n";
@@ -79,7 +278,119 @@ class Graph {
   }
 
  private:
+  static long long EdgeKey(int u, int v) {
+    return (static_cast<long long>(u) << 32) | static_cast<unsigned>(v);
+  }
+
+  void BuildEdgeIndex() const {
+    edge_index_.reserve(2 * edge_count_);
+    for (int u = 0; u < node_count_; ++u) {
+      auto &u_neighbors = adj_list_->at(u);
+      for (int i = 0; i < u_neighbors.size(); ++i) {
+        edge_index_[EdgeKey(u, u_neighbors[i].node_id)] = i;
+      }
+    }
+    is_indexed_ = true;
+  }
+
+  // Adds delta to the residual bandwidth of the i-th edge of u and of its
+  // reverse direction.
+  void AddResidualBandwidth(int u, int i, long delta) {
+    auto &end_point = adj_list_->at(u)[i];
+    end_point.residual_bandwidth += delta;
+    adj_list_->at(end_point.node_id)[end_point.reverse_index]
+        .residual_bandwidth += delta;
+  }
+
   std::unique_ptr<std::vector<std::vector<edge_endpoint> > > adj_list_;
+  // Position of every directed edge (u, v) in the adjacency list of u, built
+  // on the first lookup.
+  mutable std::unordered_map<long long, int> edge_index_;
   int node_count_, edge_count_;
+  mutable bool is_indexed_;
 };
+
+// Immutable compressed sparse row (CSR) copy of a Graph for the traversals in
+// model building and the heuristics. Directed edges get stable ids in
+// adjacency list order, i.e., the i-th edge of u in the Graph has id
+// begin(u) + i, and the edges of u are begin(u), ..., end(u) - 1. Edge
+// attributes are kept in separate contiguous arrays; residual bandwidths are
+// those at construction time or at the last UpdateResidualBandwidth().
+class CompactGraph {
+ public:
+  CompactGraph() : offset_(1, 0) {}
+  explicit CompactGraph(const Graph &graph) {
+    int node_count = graph.node_count();
+    offset_.assign(node_count + 1, 0);
+    for (int u = 0; u < node_count; ++u) {
+      offset_[u + 1] = offset_[u] + graph.adj_list()->at(u).size();
+    }
+    int edge_count = offset_[node_count];
+    tail_.resize(edge_count);
+    head_.resize(edge_count);
+    reverse_.resize(edge_count);
+    bandwidth_.resize(edge_count);
+    residual_bandwidth_.resize(edge_count);
+    cost_.resize(edge_count);
+    delay_.resize(edge_count);
+    for (int u = 0; u < node_count; ++u) {
+      auto &u_neighbors = graph.adj_list()->at(u);
+      for (int i = 0; i < u_neighbors.size(); ++i) {
+        auto &end_point = u_neighbors[i];
+        int uv = offset_[u] + i;
+        tail_[uv] = u;
+        head_[uv] = end_point.node_id;
+        reverse_[uv] = offset_[end_point.node_id] + end_point.reverse_index;
+        bandwidth_[uv] = end_point.bandwidth;
+        residual_bandwidth_[uv] = end_point.residual_bandwidth;
+        cost_[uv] = end_point.cost;
+        delay_[uv] = end_point.delay;
+      }
+    }
+  }
+
+  // Copies the residual bandwidths of graph, which must have the same
+  // adjacency lists as the graph this is a copy of.
+  void UpdateResidualBandwidth(const Graph &graph) {
+    for (int u = 0; u < node_count(); ++u) {
+      auto &u_neighbors = graph.adj_list()->at(u);
+      for (int i = 0; i < u_neighbors.size(); ++i) {
+        residual_bandwidth_[offset_[u] + i] = u_neighbors[i].residual_bandwidth;
+      }
+    }
+  }
+
+  int node_count() const { return offset_.size() - 1; }
+  // Number of directed edges, i.e., twice the number of links.
+  int edge_count() const { return head_.size(); }
+  int begin(int u) const { return offset_[u]; }
+  int end(int u) const { return offset_[u + 1]; }
+  int degree(int u) const { return offset_[u + 1] - offset_[u]; }
+
+  int tail(int uv) const { return tail_[uv]; }
+  int head(int uv) const { return head_[uv]; }
+  // Id of the edge in the opposite direction.
+  int reverse(int uv) const { return reverse_[uv]; }
+  long bandwidth(int uv) const { return bandwidth_[uv]; }
+  long residual_bandwidth(int uv) const { return residual_bandwidth_[uv]; }
+  int cost(int uv) const { return cost_[uv]; }
+  int delay(int uv) const { return delay_[uv]; }
+
+  // Returns the id of edge (u, v), or NIL if there is no such edge.
+  int edge_id(int u, int v) const {
+    for (int uv = offset_[u]; uv < offset_[u + 1]; ++uv) {
+      if (head_[uv] == v) return uv;
+    }
+    return NIL;
+  }
+
+ private:
+  // offset_[u] is the id of the first edge of u; offset_[node_count()] is the
+  // number of edges.
+  std::vector<int> offset_;
+  std::vector<int> tail_, head_, reverse_;
+  std::vector<long> bandwidth_, residual_bandwidth_;
+  std::vector<int> cost_, delay_;
+};
+
 #endif  // MIDDLEBOX_PLACEMENT_SRC_DATASTRUCTURE_H_
@@ -6,7 +6,7 @@ import argparse
 import heapq
 import networkx as nx
 import os
-import re
+import struct
 import subprocess
 
 
@@ -27,7 +27,8 @@ def execute_one_experiment(executable, pn_topology_file, vn_topology_file,
     process = subprocess.Popen([executable, '--pn_topology_file=' +
                                 pn_topology_file, '--vn_topology_file=' +
                                 vn_topology_file,
-                                '--location_constraint_file=' + location_constraint_file],
+                                '--location_constraint_file=' + location_constraint_file,
+                                '--solution_format=binary'],
                                 stdout = subprocess.PIPE, stderr = subprocess.PIPE, shell = False)
     for line in process.stdout:
         print line.strip("\r\n")
@@ -56,43 +57,45 @@ def write_util_matrix(sn, util_matrix, out_file):
             if util > 0:
                 f.write(",".join([str(key[0]), str(key[1]), str(util)]) + "\n")
 
-def update_graph_capacity(sn, vn, util_matrix, emap_file, semap_file, increase = True):
+EMBEDDING_HEADER = struct.Struct("4si32sdii")
+
+def read_embedding_header(embedding_file):
+    with open(embedding_file, "rb") as f:
+        data = f.read()
+    magic, version, status, cost, node_count, link_count = \
+            EMBEDDING_HEADER.unpack_from(data, 0)
+    if magic != "VNEE" or version != 1:
+        raise ValueError(embedding_file + " is not a version 1 embedding")
+    return data, status.rstrip("\0"), node_count, link_count
+
+# Reads the working and shadow paths of every virtual link from the binary
+# embedding snapshot (<vn_id>.emb, see snapshot.h) written by vne_protection.
+def read_embedded_links(embedding_file):
+    data, status, node_count, link_count = read_embedding_header(embedding_file)
+    link = struct.Struct("iiiii")
+    offset = EMBEDDING_HEADER.size + node_count * struct.calcsize("ii")
+    for i in range(link_count):
+        m, n, u, v, is_shadow = link.unpack_from(data, offset + i * link.size)
+        yield m, n, u, v
+
+def update_graph_capacity(sn, vn, util_matrix, embedding_file, increase = True):
     sign = 1
     if not increase:
         sign = -1
-    with open(emap_file, "r") as f:
-        for line in f:
-            matches = re.match(
-                    "Virtual edge \((\d+), (\d+)\) --> physical edge \((\d+), (\d+)\)", line.strip("\n\r"))
-            m, n, u, v = int(matches.group(1)), int(matches.group(2)), int(matches.group(3)), int(matches.group(4))
-            if m > n:
-                m, n = n, m
-            if u > v:
-                u, v = v, u
-            b_mn = int(vn.get_edge_data(m, n)['bw'])
-            sn.get_edge_data(u, v)['bw'] += (sign * b_mn)
-            util_matrix[(u, v)] += (-sign * b_mn)
-
-    with open(semap_file, "r") as f:
-        for line in f:
-            matches = re.match(
-                        "Shadow virtual edge of \((\d+), (\d+)\) --> physical edge \((\d+), (\d+)\)", line.strip("\n\r"))
-            m, n, u, v = int(matches.group(1)), int(matches.group(2)), int(matches.group(3)), int(matches.group(4))
-            if m > n:
-                m, n = n, m
-            if u > v:
-                u, v = v, u
-            b_mn = int(vn.get_edge_data(m, n)['bw'])
-            sn.get_edge_data(u, v)['bw'] += (sign * b_mn)
-            util_matrix[(u, v)] += (-sign * b_mn)
-
+    for m, n, u, v in read_embedded_links(embedding_file):
+        if m > n:
+            m, n = n, m
+        if u > v:
+            u, v = v, u
+        b_mn = int(vn.get_edge_data(m, n)['bw'])
+        sn.get_edge_data(u, v)['bw'] += (sign * b_mn)
+        util_matrix[(u, v)] += (-sign * b_mn)
     return sn
 
-def get_embedding_status(status_file):
+def get_embedding_status(embedding_file):
     ret = ''
     try:
-        with open(status_file) as f:
-            ret = f.readline().strip("\n\r")
+        ret = read_embedding_header(embedding_file)[1]
     except IOError:
         pass
     return ret
@@ -145,14 +148,14 @@ def main():
         vn = load_csv_graph(args.vnr_directory + "/" + e.vn_id)
         if e.etype == "departure":
             # if the embedding of vn_id was not successful at the first place do
-            # nothing. This can be checked by reading from $(vn_id).status file.
+            # nothing. This can be checked by reading from $(vn_id).emb file.
             # If there was a successful embedding increase graph's capacity.
-            status = get_embedding_status(args.vnr_directory + "/" + e.vn_id + ".status")
+            status = get_embedding_status(args.vnr_directory + "/" + e.vn_id + ".emb")
             print status
             if status == "Optimal" or status == "Successful":
                 sn = update_graph_capacity(sn, vn, util_matrix,
-                            args.vnr_directory + "/" + e.vn_id + ".emap", 
-                            args.vnr_directory + "/" + e.vn_id + ".semap", increase = True)
+                            args.vnr_directory + "/" + e.vn_id + ".emb",
+                            increase = True)
                 write_csv_graph(sn, args.phys_topology)
                 write_util_matrix(sn, util_matrix, "sim-data/util-data/util." + str(e.ts))
         elif e.etype == "arrival":
@@ -167,11 +170,11 @@ def main():
                                                      e.vn_id + "loc")
             execute_one_experiment(args.executable, pn_topology_file,
                                    vn_topology_file, location_constraint_file)
-            status = get_embedding_status(args.vnr_directory  + "/" + e.vn_id + ".status")
+            status = get_embedding_status(args.vnr_directory  + "/" + e.vn_id + ".emb")
             if status == "Optimal" or status == "Successful":
                 sn = update_graph_capacity(sn, vn, util_matrix,
-                           args.vnr_directory + "/" + e.vn_id + ".emap", 
-                           args.vnr_directory + "/" + e.vn_id + ".semap", increase = False)
+                           args.vnr_directory + "/" + e.vn_id + ".emb",
+                           increase = False)
                 write_csv_graph(sn, args.phys_topology)
                 write_util_matrix(sn, util_matrix, "sim-data/util-data/util." + str(e.ts))
                 accepted_vns += 1
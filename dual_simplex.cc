@@ -0,0 +1,445 @@
+#include "dual_simplex.h"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+const double kPrimalTolerance = 1e-7;
+const double kDualTolerance = 1e-9;
+const double kPivotTolerance = 1e-5;
+const double kZeroTolerance = 1e-12;
+const long kRefreshInterval = 100;
+const long kReinvertInterval = 500;
+const double kPerturbation = 1e-5;
+// Relative margin by which the objective has to exceed its largest value
+// within the bounds before a problem is declared infeasible.
+const double kInfeasibilityTolerance = 1e-6;
+}  // namespace
+
+const double DualSimplex::kArtificialBound = 1e9;
+
+void DualSimplex::Load(const std::vector<double> &cost,
+                       const std::vector<double> &lb,
+                       const std::vector<double> &ub,
+                       const std::vector<SimplexRow> &rows) {
+  num_columns_ = cost.size();
+  num_rows_ = rows.size();
+  rows_ = rows;
+  width_ = num_columns_ + num_rows_;
+  tableau_.assign(static_cast<size_t>(num_rows_) * width_, 0.0);
+  beta_.resize(num_rows_);
+  cost_.assign(width_, 0.0);
+  original_cost_ = cost;
+  lb_.resize(width_);
+  ub_.resize(width_);
+  x_.assign(width_, 0.0);
+  d_.assign(width_, 0.0);
+  basis_.resize(num_rows_);
+  row_of_.assign(width_, -1);
+  weight_.assign(num_rows_, 1.0);
+
+  // Perturb the costs to avoid stalling on dual degenerate problems, which
+  // are common in network models where many columns have zero cost.
+  // perturbation_ bounds the effect on the objective.
+  perturbation_ = 0.0;
+  unsigned int seed = 0x5414ab;
+  for (int j = 0; j < num_columns_; ++j) {
+    seed = seed * 1103515245u + 12345u;
+    double random = ((seed >> 16) & 0x7fff) / 32768.0;
+    double epsilon = kPerturbation * (1.0 + random) * (1.0 + fabs(cost[j]));
+    cost_[j] = cost[j] + epsilon;
+    lb_[j] = lb[j];
+    ub_[j] = ub[j];
+    double max_magnitude = std::max(fabs(lb[j]), fabs(ub[j]));
+    if (max_magnitude >= MIP_INFINITY) max_magnitude = kArtificialBound;
+    perturbation_ += epsilon * max_magnitude;
+  }
+  for (int i = 0; i < num_rows_; ++i) {
+    auto &row = rows[i];
+    for (auto &term : row.terms) T(i, term.first) += term.second;
+    int slack = num_columns_ + i;
+    T(i, slack) = 1.0;
+    beta_[i] = row.rhs;
+    SetSlackBounds(i);
+    basis_[i] = slack;
+    row_of_[slack] = i;
+  }
+  iterations_ = 0;
+  pivots_since_reinvert_ = 0;
+  for (int j = 0; j < num_columns_; ++j) d_[j] = cost_[j];
+  for (int j = 0; j < num_columns_; ++j) {
+    if (d_[j] >= 0.0) {
+      x_[j] = lb_[j] > -MIP_INFINITY ? lb_[j] : -kArtificialBound;
+    } else {
+      x_[j] = ub_[j] < MIP_INFINITY ? ub_[j] : kArtificialBound;
+    }
+  }
+  Refresh();
+}
+
+void DualSimplex::GetDuals(std::vector<double> *duals) const {
+  // The slack columns of the tableau hold B^-1.
+  duals->assign(num_rows_, 0.0);
+  for (int i = 0; i < num_rows_; ++i) {
+    int column = basis_[i];
+    double c_b = column < num_columns_ ? original_cost_[column] : 0.0;
+    if (c_b == 0.0) continue;
+    const double *row =
+        &tableau_[static_cast<size_t>(i) * width_ + num_columns_];
+    for (int k = 0; k < num_rows_; ++k) (*duals)[k] += c_b * row[k];
+  }
+}
+
+void DualSimplex::SetSlackBounds(int row) {
+  // sum(a_j * x_j) + s = rhs.
+  int slack = num_columns_ + row;
+  switch (rows_[row].sense) {
+    case kLessEqual:
+      lb_[slack] = 0.0;
+      ub_[slack] = MIP_INFINITY;
+      break;
+    case kGreaterEqual:
+      lb_[slack] = -MIP_INFINITY;
+      ub_[slack] = 0.0;
+      break;
+    case kEqual:
+      lb_[slack] = ub_[slack] = 0.0;
+      break;
+  }
+}
+
+void DualSimplex::AddRows(const std::vector<SimplexRow> &rows) {
+  // Slack columns follow the structural ones in row order, so the new slacks
+  // are appended and no column changes its index. The tableau changes its
+  // width and is rebuilt for the extended basis.
+  for (auto &row : rows) {
+    int i = num_rows_++;
+    rows_.push_back(row);
+    basis_.push_back(num_columns_ + i);
+  }
+  width_ = num_columns_ + num_rows_;
+  tableau_.assign(static_cast<size_t>(num_rows_) * width_, 0.0);
+  beta_.resize(num_rows_);
+  cost_.resize(width_, 0.0);
+  lb_.resize(width_);
+  ub_.resize(width_);
+  x_.resize(width_, 0.0);
+  d_.resize(width_, 0.0);
+  row_of_.resize(width_);
+  weight_.resize(num_rows_);
+  for (int i = num_rows_ - rows.size(); i < num_rows_; ++i) SetSlackBounds(i);
+  Reinvert();
+}
+
+bool DualSimplex::AtLower(int column) const {
+  return x_[column] == lb_[column] || x_[column] == -kArtificialBound;
+}
+
+double DualSimplex::DualInfeasibilitySlack(int column, bool at_lower) const {
+  double d = at_lower ? d_[column] : -d_[column];
+  return d > 0.0 ? d : 0.0;
+}
+
+void DualSimplex::PlaceNonbasic(int column) {
+  double value;
+  bool has_lower = lb_[column] > -MIP_INFINITY;
+  bool has_upper = ub_[column] < MIP_INFINITY;
+  if (lb_[column] == ub_[column]) {
+    value = lb_[column];
+  } else if (d_[column] >= 0.0) {
+    value = has_lower ? lb_[column] : -kArtificialBound;
+  } else {
+    value = has_upper ? ub_[column] : kArtificialBound;
+  }
+  // Slack columns only have one finite bound. A reduced cost of the wrong
+  // sign can only be a rounding error then; treat it as zero rather than
+  // moving the column to an artificial bound.
+  if (has_lower != has_upper && fabs(value) == kArtificialBound) {
+    value = has_lower ? lb_[column] : ub_[column];
+    d_[column] = 0.0;
+  }
+  double delta = value - x_[column];
+  if (delta == 0.0) return;
+  for (int i = 0; i < num_rows_; ++i) {
+    double alpha = T(i, column);
+    if (alpha != 0.0) x_[basis_[i]] -= alpha * delta;
+  }
+  x_[column] = value;
+  objective_ += d_[column] * delta;
+}
+
+void DualSimplex::SetBounds(int column, double lb, double ub) {
+  lb_[column] = lb;
+  ub_[column] = ub;
+  if (row_of_[column] < 0) PlaceNonbasic(column);
+}
+
+void DualSimplex::Refresh() {
+  // x_B = B^-1 b - sum over nonbasic j of (B^-1 A_j) x_j.
+  for (int i = 0; i < num_rows_; ++i) {
+    double value = beta_[i];
+    const double *row = &tableau_[static_cast<size_t>(i) * width_];
+    for (int j = 0; j < width_; ++j) {
+      if (row_of_[j] < 0 && x_[j] != 0.0 && row[j] != 0.0) {
+        value -= row[j] * x_[j];
+      }
+    }
+    x_[basis_[i]] = value;
+  }
+  // d_j = c_j - c_B B^-1 A_j.
+  for (int j = 0; j < width_; ++j) d_[j] = cost_[j];
+  for (int i = 0; i < num_rows_; ++i) {
+    double c_b = cost_[basis_[i]];
+    if (c_b == 0.0) continue;
+    const double *row = &tableau_[static_cast<size_t>(i) * width_];
+    for (int j = 0; j < width_; ++j) {
+      if (row[j] != 0.0) d_[j] -= c_b * row[j];
+    }
+  }
+  for (int i = 0; i < num_rows_; ++i) d_[basis_[i]] = 0.0;
+  objective_ = 0.0;
+  for (int j = 0; j < num_columns_; ++j) objective_ += cost_[j] * x_[j];
+  // Rounding errors may leave a nonbasic column at the wrong bound.
+  for (int j = 0; j < width_; ++j) {
+    if (row_of_[j] >= 0 || lb_[j] == ub_[j]) continue;
+    bool at_lower = AtLower(j);
+    if ((at_lower && d_[j] < -kDualTolerance) ||
+        (!at_lower && d_[j] > kDualTolerance)) {
+      PlaceNonbasic(j);
+    }
+  }
+  pivots_since_refresh_ = 0;
+}
+
+void DualSimplex::Eliminate(int row, int column) {
+  double *pivot_row = &tableau_[static_cast<size_t>(row) * width_];
+  double inverse = 1.0 / pivot_row[column];
+  std::vector<int> nonzeros;
+  for (int j = 0; j < width_; ++j) {
+    if (pivot_row[j] == 0.0) continue;
+    pivot_row[j] *= inverse;
+    if (fabs(pivot_row[j]) < kZeroTolerance) {
+      pivot_row[j] = 0.0;
+    } else {
+      nonzeros.push_back(j);
+    }
+  }
+  pivot_row[column] = 1.0;
+  beta_[row] *= inverse;
+  for (int i = 0; i < num_rows_; ++i) {
+    if (i == row) continue;
+    double *current_row = &tableau_[static_cast<size_t>(i) * width_];
+    double factor = current_row[column];
+    if (factor == 0.0) continue;
+    for (int j : nonzeros) {
+      double value = current_row[j] - factor * pivot_row[j];
+      current_row[j] = fabs(value) < kZeroTolerance ? 0.0 : value;
+    }
+    current_row[column] = 0.0;
+    beta_[i] -= factor * beta_[row];
+  }
+}
+
+void DualSimplex::Pivot(int row, int column) {
+  Eliminate(row, column);
+  int leaving = basis_[row];
+  row_of_[leaving] = -1;
+  basis_[row] = column;
+  row_of_[column] = row;
+  ++pivots_since_refresh_;
+  ++pivots_since_reinvert_;
+}
+
+void DualSimplex::SetBasis(const std::vector<int> &basis) {
+  basis_ = basis;
+  for (int i = basis.size(); i < num_rows_; ++i) {
+    basis_.push_back(num_columns_ + i);
+  }
+  Reinvert();
+}
+
+void DualSimplex::Reinvert() {
+  // Rebuild B^-1 [A | I] from the original rows by Gauss-Jordan elimination
+  // on the basic columns. Basic slacks keep their own row, which is already a
+  // unit column, the other rows are assigned with partial pivoting.
+  std::fill(tableau_.begin(), tableau_.end(), 0.0);
+  std::vector<int> old_basis = basis_;
+  std::vector<bool> assigned(num_rows_, false);
+  for (int i = 0; i < num_rows_; ++i) {
+    for (auto &term : rows_[i].terms) T(i, term.first) += term.second;
+    T(i, num_columns_ + i) = 1.0;
+    beta_[i] = rows_[i].rhs;
+  }
+  for (int j = 0; j < width_; ++j) row_of_[j] = -1;
+  for (int column : old_basis) {
+    if (column < num_columns_) continue;
+    int row = column - num_columns_;
+    basis_[row] = column;
+    row_of_[column] = row;
+    assigned[row] = true;
+  }
+  for (int column : old_basis) {
+    if (column >= num_columns_) continue;
+    int row = -1;
+    double max_alpha = kPivotTolerance;
+    for (int i = 0; i < num_rows_; ++i) {
+      if (!assigned[i] && fabs(T(i, column)) > max_alpha) {
+        max_alpha = fabs(T(i, column));
+        row = i;
+      }
+    }
+    // Skip columns that make the basis numerically singular.
+    if (row < 0) continue;
+    Eliminate(row, column);
+    basis_[row] = column;
+    row_of_[column] = row;
+    assigned[row] = true;
+  }
+  // Replace dropped columns by the slacks of the rows left over.
+  for (int i = 0; i < num_rows_; ++i) {
+    if (assigned[i]) continue;
+    basis_[i] = num_columns_ + i;
+    row_of_[num_columns_ + i] = i;
+  }
+  // Columns that left the basis start at a bound; Refresh() moves them to
+  // the dual feasible one.
+  for (int j = 0; j < width_; ++j) {
+    if (row_of_[j] >= 0 || x_[j] == lb_[j] || x_[j] == ub_[j] ||
+        fabs(x_[j]) == kArtificialBound) {
+      continue;
+    }
+    if (lb_[j] > -MIP_INFINITY) {
+      x_[j] = lb_[j];
+    } else {
+      x_[j] = ub_[j] < MIP_INFINITY ? ub_[j] : -kArtificialBound;
+    }
+  }
+  std::fill(weight_.begin(), weight_.end(), 1.0);
+  pivots_since_reinvert_ = 0;
+  Refresh();
+}
+
+DualSimplex::Status DualSimplex::Solve(double cutoff, long iteration_limit) {
+  long iteration = 0;
+  bool reinverted = false;
+  // No point within the bounds has a larger objective. If the objective of a
+  // dual feasible basis exceeds it, the dual is unbounded and the problem
+  // infeasible. Without this, infeasible problems are only recognized after
+  // many pivots with ever larger reduced costs, which can take long enough
+  // to stall branch-and-bound before the first incumbent gives a cutoff.
+  double max_objective = 0.0;
+  for (int j = 0; j < num_columns_; ++j) {
+    if (cost_[j] == 0.0) continue;
+    double bound = cost_[j] > 0.0 ? ub_[j] : lb_[j];
+    if (fabs(bound) >= MIP_INFINITY) {
+      max_objective = MIP_INFINITY;
+      break;
+    }
+    max_objective += cost_[j] * bound;
+  }
+  max_objective +=
+      kInfeasibilityTolerance * std::max(1.0, fabs(max_objective));
+  while (true) {
+    if (pivots_since_reinvert_ >= kReinvertInterval) {
+      Reinvert();
+    } else if (pivots_since_refresh_ >= kRefreshInterval) {
+      Refresh();
+    }
+    if (objective_lower_bound() > cutoff) return kCutoff;
+    if (objective_ > max_objective) return kInfeasible;
+    // Leaving row: dual Devex pricing, i.e., the largest squared bound
+    // violation relative to the row's reference weight.
+    int r = -1;
+    double best_score = 0.0;
+    for (int i = 0; i < num_rows_; ++i) {
+      int column = basis_[i];
+      double violation = 0.0;
+      if (x_[column] < lb_[column] - kPrimalTolerance) {
+        violation = lb_[column] - x_[column];
+      } else if (x_[column] > ub_[column] + kPrimalTolerance) {
+        violation = x_[column] - ub_[column];
+      }
+      if (violation == 0.0) continue;
+      double score = violation * violation / weight_[i];
+      if (score > best_score) {
+        best_score = score;
+        r = i;
+      }
+    }
+    if (r < 0) return kOptimal;
+    if (iteration++ >= iteration_limit) return kIterationLimit;
+
+    int leaving = basis_[r];
+    bool increase = x_[leaving] < lb_[leaving];
+    double target = increase ? lb_[leaving] : ub_[leaving];
+    const double *pivot_row = &tableau_[static_cast<size_t>(r) * width_];
+
+    // Ratio test (two pass, Harris): find the largest dual step that keeps
+    // all reduced costs within tolerance, then pick the candidate with the
+    // largest pivot element among those not exceeding it.
+    double max_step = MIP_INFINITY;
+    for (int j = 0; j < width_; ++j) {
+      double alpha = pivot_row[j];
+      if (row_of_[j] >= 0 || fabs(alpha) < kPivotTolerance) continue;
+      if (lb_[j] == ub_[j]) continue;
+      bool at_lower = AtLower(j);
+      // x_leaving changes by -alpha * delta_j.
+      if (at_lower != (increase ? alpha < 0.0 : alpha > 0.0)) continue;
+      double step = (DualInfeasibilitySlack(j, at_lower) + kDualTolerance) /
+                    fabs(alpha);
+      if (step < max_step) max_step = step;
+    }
+    int q = -1;
+    double best_alpha = 0.0;
+    for (int j = 0; j < width_; ++j) {
+      double alpha = pivot_row[j];
+      if (row_of_[j] >= 0 || fabs(alpha) < kPivotTolerance) continue;
+      if (lb_[j] == ub_[j]) continue;
+      bool at_lower = AtLower(j);
+      if (at_lower != (increase ? alpha < 0.0 : alpha > 0.0)) continue;
+      if (DualInfeasibilitySlack(j, at_lower) / fabs(alpha) <= max_step &&
+          fabs(alpha) > best_alpha) {
+        best_alpha = fabs(alpha);
+        q = j;
+      }
+    }
+    if (q < 0) {
+      // Make sure infeasibility is not an artifact of rounding errors.
+      if (reinverted || pivots_since_reinvert_ == 0) return kInfeasible;
+      Reinvert();
+      reinverted = true;
+      continue;
+    }
+
+    // Primal and Devex weight update.
+    double alpha_q = pivot_row[q];
+    double t = (x_[leaving] - target) / alpha_q;
+    for (int i = 0; i < num_rows_; ++i) {
+      double alpha = tableau_[static_cast<size_t>(i) * width_ + q];
+      if (alpha == 0.0) continue;
+      x_[basis_[i]] -= alpha * t;
+      if (i == r) continue;
+      double ratio = alpha / alpha_q;
+      weight_[i] = std::max(weight_[i], ratio * ratio * weight_[r]);
+    }
+    weight_[r] = std::max(weight_[r] / (alpha_q * alpha_q), 1.0);
+    x_[q] += t;
+    x_[leaving] = target;
+    objective_ += d_[q] * t;
+
+    // Dual update.
+    double theta = d_[q] / alpha_q;
+    if (theta != 0.0) {
+      for (int j = 0; j < width_; ++j) {
+        if (row_of_[j] < 0 && pivot_row[j] != 0.0) {
+          d_[j] -= theta * pivot_row[j];
+        }
+      }
+    }
+    d_[leaving] = -theta;
+    d_[q] = 0.0;
+
+    Pivot(r, q);
+    ++iterations_;
+  }
+}
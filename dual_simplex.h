@@ -0,0 +1,118 @@
+#ifndef DUAL_SIMPLEX_H_
+#define DUAL_SIMPLEX_H_
+
+#include "mip_backend.h"
+
+#include <utility>
+#include <vector>
+
+// A row of a linear program in the form sum(a_j * x_j) (<=, >=, ==) rhs.
+struct SimplexRow {
+  std::vector<std::pair<int, double> > terms;
+  ConstraintSense sense;
+  double rhs;
+};
+
+// Bounded dual simplex over a dense tableau for problems of the form
+//   min c x subject to rows, lb <= x <= ub.
+// Every row gets a slack column, so the tableau has num_columns + num_rows
+// columns and the initial basis consists of the slacks only. The tableau is
+// kept between calls to Solve(), which makes re-optimization after bound
+// changes (as done during branch-and-bound) cheap: reduced costs do not
+// depend on bounds, so the basis stays dual feasible and only a few dual
+// pivots are needed to restore primal feasibility.
+class DualSimplex {
+ public:
+  enum Status { kOptimal, kInfeasible, kCutoff, kIterationLimit };
+
+  DualSimplex() : num_rows_(0), num_columns_(0), width_(0) {}
+
+  // Loads the problem. Bounds may be infinite (+-MIP_INFINITY), but the
+  // initial basis needs every structural column to have a finite bound in
+  // the direction its cost pushes it, so infinite bounds are replaced by
+  // kArtificialBound in that case.
+  void Load(const std::vector<double> &cost, const std::vector<double> &lb,
+            const std::vector<double> &ub, const std::vector<SimplexRow> &rows);
+
+  // Appends rows, e.g., constraints violated by the current solution. Their
+  // slacks enter the basis, so the basis stays dual feasible and Solve()
+  // re-optimizes from it.
+  void AddRows(const std::vector<SimplexRow> &rows);
+
+  // Changes the bounds of a structural column.
+  void SetBounds(int column, double lb, double ub);
+
+  // Returns the basic column of every row. Passing it to SetBasis() later
+  // restores the basis, e.g., when backtracking during branch-and-bound. The
+  // slacks of rows added since the basis was taken are added to it.
+  const std::vector<int> &basis() const { return basis_; }
+  void SetBasis(const std::vector<int> &basis);
+
+  // Runs dual simplex iterations until the current basis is primal feasible
+  // (kOptimal), the problem is proven infeasible (kInfeasible), the objective
+  // exceeds cutoff (kCutoff) or iteration_limit pivots have been made.
+  Status Solve(double cutoff, long iteration_limit);
+
+  int num_rows() const { return num_rows_; }
+  int num_columns() const { return num_columns_; }
+  double lb(int column) const { return lb_[column]; }
+  double ub(int column) const { return ub_[column]; }
+  double value(int column) const { return x_[column]; }
+  // Objective of the current basis under the perturbed costs, and a lower
+  // bound of the objective under the original costs.
+  double objective() const { return objective_; }
+  double objective_lower_bound() const { return objective_ - perturbation_; }
+  long iterations() const { return iterations_; }
+  // Dual values c_B B^-1 of the rows in the current basis under the original
+  // costs, i.e., without the perturbation.
+  void GetDuals(std::vector<double> *duals) const;
+
+  static const double kArtificialBound;
+
+ private:
+  double &T(int row, int column) { return tableau_[row * width_ + column]; }
+
+  // Returns true if a nonbasic column sits at its lower bound.
+  bool AtLower(int column) const;
+  // Reduced cost of a nonbasic column in the direction it may move, clamped
+  // at zero, i.e., how far the dual step may go before it turns infeasible.
+  double DualInfeasibilitySlack(int column, bool at_lower) const;
+  // Places a nonbasic column at the bound that keeps it dual feasible and
+  // updates the basic variables accordingly.
+  void PlaceNonbasic(int column);
+  // Recomputes basic variable values, reduced costs and the objective from
+  // the tableau to limit the accumulation of rounding errors.
+  void Refresh();
+  // Sets the bounds of the slack column of row.
+  void SetSlackBounds(int row);
+  // Recomputes the tableau of the current basis from the original rows.
+  void Reinvert();
+  // Gauss-Jordan elimination step on the tableau with the given pivot.
+  void Eliminate(int row, int column);
+  // Eliminates and exchanges the basic column of row with column.
+  void Pivot(int row, int column);
+
+  std::vector<SimplexRow> rows_;
+  int num_rows_, num_columns_;
+  // Number of tableau columns, i.e., structural plus slack columns.
+  int width_;
+  // Dense tableau B^-1 [A | I] in row major order and B^-1 b.
+  std::vector<double> tableau_;
+  std::vector<double> beta_;
+  std::vector<double> cost_, lb_, ub_;
+  // Costs of the structural columns without the perturbation.
+  std::vector<double> original_cost_;
+  // Current value and reduced cost of every column.
+  std::vector<double> x_, d_;
+  // Basic column of every row; row of every basic column or -1.
+  std::vector<int> basis_, row_of_;
+  // Dual Devex reference weights of the rows.
+  std::vector<double> weight_;
+  double perturbation_;
+  double objective_;
+  long iterations_;
+  long pivots_since_refresh_;
+  long pivots_since_reinvert_;
+};
+
+#endif  // DUAL_SIMPLEX_H_
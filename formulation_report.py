@@ -0,0 +1,69 @@
+# Solves every test case of a test set (TestSet-0 or TestSet-1 layout, see
+# README.md) with each formulation of the disjointness constraints and
+# reports the model size, the root bound and the solve time side by side.
+# With --lazy the linear formulations are also solved with lazy disjointness
+# constraints, and with --symmetry_breaking every formulation is also solved
+# with symmetry breaking constraints.
+import argparse
+import csv
+import subprocess
+
+FORMULATIONS = [("indicator", ["--formulation=indicator"]),
+                ("aggregated", ["--formulation=aggregated"]),
+                ("disaggregated", ["--formulation=disaggregated"])]
+LAZY_FORMULATIONS = [("aggregated_lazy", ["--formulation=aggregated",
+                                          "--lazy_disjointness=true"]),
+                     ("disaggregated_lazy", ["--formulation=disaggregated",
+                                             "--lazy_disjointness=true"])]
+
+def run_batch(executable, testcase_root, name, formulation_args, extra_args):
+    results_file = "formulation-%s.csv" % name
+    subprocess.check_call([executable, '--batch=' + testcase_root,
+            '--results_file=' + results_file] + formulation_args + extra_args)
+    with open(results_file) as f:
+        return dict((row["testcase"], row) for row in csv.DictReader(f))
+
+def main():
+    parser = argparse.ArgumentParser(
+            description = "Compares the formulations of the ILP model",
+            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--testcase_root',
+            help='Root directory for test cases', required=True)
+    parser.add_argument('--executable',
+            help='Name of the executable file to run',
+            default='vne_protection')
+    parser.add_argument('--time_limit',
+            help='Time limit per test case in seconds', default='600')
+    parser.add_argument('--lazy', action='store_true',
+            help='Also solve with lazy disjointness constraints')
+    parser.add_argument('--symmetry_breaking', action='store_true',
+            help='Also solve with symmetry breaking constraints')
+    args = parser.parse_args()
+    executable = './' + args.executable
+    formulations = FORMULATIONS + (LAZY_FORMULATIONS if args.lazy else [])
+    if args.symmetry_breaking:
+        formulations += [(name + "_symmetry",
+                          formulation_args + ["--symmetry_breaking=true"])
+                         for name, formulation_args in formulations]
+    names = [name for name, _ in formulations]
+    results = {}
+    for name, formulation_args in formulations:
+        results[name] = run_batch(executable, args.testcase_root, name,
+                formulation_args, ['--time_limit=' + args.time_limit])
+    columns = ["status", "cost", "constraints", "lazy_constraints",
+               "root_bound", "nodes", "solve_time"]
+    print "testcase," + ",".join(name + "_" + column
+            for name in names for column in columns)
+    for testcase in sorted(results[names[0]]):
+        print testcase + "," + ",".join(results[name][testcase][column]
+                for name in names for column in columns)
+    for name in names:
+        times = [float(row["solve_time"]) for row in results[name].values()]
+        solved = [row for row in results[name].values()
+                if row["status"] == "Optimal"]
+        print "%s: %d of %d test cases solved to optimality, mean solve " \
+              "time = %.3f s" % (name, len(solved), len(times),
+                      sum(times) / max(1, len(times)))
+
+if __name__ == "__main__":
+    main()
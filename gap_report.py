@@ -0,0 +1,76 @@
+# Runs the ILP and the heuristic solver on every test case of a test set
+# (TestSet-0 or TestSet-1 layout, see README.md) and reports the cost of both
+# solutions and the optimality gap of the heuristic.
+import argparse
+import os
+import subprocess
+import time
+
+def find_testcases(root):
+    for test in sorted(tuple(os.walk(root))[0][1]):
+        path = os.path.join(root, test)
+        if os.path.isfile(path + "/sn2.txt"):
+            pn_topology_file = os.path.join(path, "sn2.txt")
+        else:
+            pn_topology_file = os.path.join(path, "sn.txt")
+        vnr_dirs = list(os.walk(path))[0][1]
+        if len(vnr_dirs) <= 0:
+            yield pn_topology_file, path
+            continue
+        for vnr_root in sorted(vnr_dirs):
+            vnr_types = tuple(os.walk(os.path.join(path, vnr_root)))[0][1]
+            for vnr_type in sorted(vnr_types):
+                vnr_cases = tuple(os.walk(os.path.join(path, vnr_root,
+                    vnr_type)))[0][1]
+                for vnr_case in sorted(vnr_cases):
+                    yield pn_topology_file, os.path.join(path, vnr_root,
+                            vnr_type, vnr_case)
+
+def run_solver(executable, solver, pn_topology_file, vnr_root):
+    vn_topology_file = os.path.join(vnr_root, "vn.txt")
+    start = time.time()
+    process = subprocess.Popen([executable, '--pn_topology_file=' +
+            pn_topology_file, '--vn_topology_file=' + vn_topology_file,
+            '--location_constraint_file=' + os.path.join(vnr_root, "vnloc.txt"),
+            '--solver=' + solver],
+            stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=False)
+    process.communicate()
+    elapsed = time.time() - start
+    with open(vn_topology_file + ".status") as f:
+        status = f.read().strip()
+    cost = None
+    if status == "Optimal" or status == "Successful":
+        with open(vn_topology_file + ".cost") as f:
+            cost = float(f.read().strip())
+    return status, cost, elapsed
+
+def main():
+    parser = argparse.ArgumentParser(
+            description = "Compares the heuristic solver against the ILP",
+            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--testcase_root',
+            help='Root directory for test cases', required=True)
+    parser.add_argument('--executable',
+            help='Name of the executable file to run',
+            default='vne_protection')
+    args = parser.parse_args()
+    executable = './' + args.executable
+    gaps = []
+    print "testcase,ilp_status,ilp_cost,ilp_time,heuristic_status," \
+          "heuristic_cost,heuristic_time,gap"
+    for pn_topology_file, vnr_root in find_testcases(args.testcase_root):
+        ilp = run_solver(executable, "ilp", pn_topology_file, vnr_root)
+        heuristic = run_solver(executable, "heuristic", pn_topology_file,
+                vnr_root)
+        gap = ""
+        if ilp[1] and heuristic[1] is not None:
+            gaps.append((heuristic[1] - ilp[1]) / ilp[1])
+            gap = "%.4f" % gaps[-1]
+        print ",".join([vnr_root, ilp[0], str(ilp[1]), "%.3f" % ilp[2],
+                heuristic[0], str(heuristic[1]), "%.3f" % heuristic[2], gap])
+    if len(gaps) > 0:
+        print "Mean gap = %.4f, max gap = %.4f over %d test cases" % (
+                sum(gaps) / len(gaps), max(gaps), len(gaps))
+
+if __name__ == "__main__":
+    main()
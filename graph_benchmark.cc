@@ -0,0 +1,201 @@
+// Micro-benchmark of the adjacency list Graph against its CompactGraph copy:
+// construction time and the time of the edge traversals done while building
+// the ILP model, on a synthetic physical network or one read from a file.
+// Files are also loaded with the former line-by-line stdio parser to compare
+// its throughput with the memory mapped one in io.h.
+#include "datastructure.h"
+#include "io.h"
+
+#include <chrono>
+#include <random>
+
+const std::string kUsage = "./graph_benchmark "
+                           "[--pn_topology_file=<pn_topology_file>]\n\t"
+                           "[--nodes=<n>] [--degree=<d>] "
+                           "[--repetitions=<r>]\n\t"
+                           "[--write_topology_file=<topology_file>]";
+
+namespace {
+double SecondsSince(std::chrono::steady_clock::time_point start) {
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count();
+}
+
+// A ring, which keeps the network connected, plus random links up to an
+// average degree of degree.
+std::unique_ptr<Graph> GenerateTopology(int nodes, int degree) {
+  std::mt19937 random(nodes);
+  std::uniform_int_distribution<int> node(0, nodes - 1);
+  std::uniform_int_distribution<int> bandwidth(1, 10);
+  std::uniform_int_distribution<int> cost(1, 5);
+  std::unique_ptr<Graph> graph(new Graph());
+  for (int u = 0; u < nodes; ++u) {
+    graph->add_edge(u, (u + 1) % nodes, 1000 * bandwidth(random), 1,
+                    cost(random));
+  }
+  long links = static_cast<long>(nodes) * degree / 2;
+  while (graph->edge_count() < links) {
+    int u = node(random), v = node(random);
+    if (u == v || graph->edge_index(u, v) != NIL) continue;
+    graph->add_edge(u, v, 1000 * bandwidth(random), 1, cost(random));
+  }
+  return graph;
+}
+
+void WriteTopology(const Graph &graph, const char *filename) {
+  FILE *file = fopen(filename, "w");
+  if (!file) return;
+  int link = 0;
+  for (int u = 0; u < graph.node_count(); ++u) {
+    for (auto &end_point : graph.adj_list()->at(u)) {
+      if (end_point.node_id < u) continue;
+      fprintf(file, "%d,%d,%d,0,%d,%ld,%d\n", link++, u, end_point.node_id,
+              end_point.cost, end_point.bandwidth, end_point.delay);
+    }
+  }
+  fclose(file);
+}
+
+// The loader io.h had before it mapped files: fgets into a fixed buffer,
+// strtok and a vector of strings per line, then atoi.
+std::unique_ptr<Graph> LoadTopologyWithStdio(const char *filename) {
+  FILE *file = fopen(filename, "r");
+  if (!file) return nullptr;
+  char line_buffer[1024];
+  std::vector<std::vector<std::string> > rows;
+  while (fgets(line_buffer, sizeof(line_buffer), file)) {
+    if (line_buffer[0] == '\n' || line_buffer[0] == '\r') continue;
+    std::vector<std::string> row;
+    for (char *token = strtok(line_buffer, ",\n\r"); token;
+         token = strtok(NULL, ",\n")) {
+      row.push_back(token);
+    }
+    rows.push_back(row);
+  }
+  fclose(file);
+  std::unique_ptr<Graph> graph(new Graph());
+  for (auto &row : rows) {
+    if (row.size() < 7) return nullptr;
+    graph->add_edge(atoi(row[1].c_str()), atoi(row[2].c_str()),
+                    atol(row[5].c_str()), atoi(row[6].c_str()),
+                    atoi(row[4].c_str()));
+  }
+  return graph;
+}
+
+// Visits every directed edge and its reverse direction once, like the
+// capacity and flow constraints of the model, and returns a checksum.
+long TraverseAdjacencyList(const Graph &graph) {
+  long checksum = 0;
+  for (int u = 0; u < graph.node_count(); ++u) {
+    auto &u_neighbors = graph.adj_list()->at(u);
+    for (int i = 0; i < u_neighbors.size(); ++i) {
+      auto &end_point = u_neighbors[i];
+      auto &reverse =
+          graph.adj_list()->at(end_point.node_id).at(end_point.reverse_index);
+      checksum += end_point.residual_bandwidth * end_point.cost +
+                  reverse.node_id;
+    }
+  }
+  return checksum;
+}
+
+long TraverseCompactGraph(const CompactGraph &graph) {
+  long checksum = 0;
+  for (int u = 0; u < graph.node_count(); ++u) {
+    for (int uv = graph.begin(u); uv < graph.end(u); ++uv) {
+      checksum += graph.residual_bandwidth(uv) * graph.cost(uv) +
+                  graph.head(graph.reverse(uv));
+    }
+  }
+  return checksum;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  auto arg_map = ParseArgs(argc, argv);
+  std::string pn_topology_filename = "", write_topology_filename = "";
+  int nodes = 100000, degree = 8, repetitions = 20;
+  for (auto argument : *arg_map) {
+    if (argument.first == "--pn_topology_file") {
+      pn_topology_filename = argument.second;
+    } else if (argument.first == "--write_topology_file") {
+      write_topology_filename = argument.second;
+    } else if (argument.first == "--nodes") {
+      nodes = atoi(argument.second.c_str());
+    } else if (argument.first == "--degree") {
+      degree = atoi(argument.second.c_str());
+    } else if (argument.first == "--repetitions") {
+      repetitions = atoi(argument.second.c_str());
+    } else {
+      printf("Unknown option %s\n%s\n", argument.first.c_str(),
+             kUsage.c_str());
+      return 1;
+    }
+  }
+  if (nodes < 3 || degree < 2 || degree >= nodes || repetitions < 1) {
+    printf("%s\n", kUsage.c_str());
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_ptr<Graph> graph =
+      pn_topology_filename.empty()
+          ? GenerateTopology(nodes, degree)
+          : InitializeTopologyFromFile(pn_topology_filename.c_str());
+  double graph_build_time = SecondsSince(start);
+  if (!graph) return 1;
+  if (!write_topology_filename.empty()) {
+    WriteTopology(*graph, write_topology_filename.c_str());
+    printf("%d links written to %s\n", graph->edge_count(),
+           write_topology_filename.c_str());
+    return 0;
+  }
+  if (!pn_topology_filename.empty()) {
+    struct stat info;
+    double megabytes =
+        stat(pn_topology_filename.c_str(), &info) == 0 ? info.st_size / 1e6
+                                                       : 0.0;
+    start = std::chrono::steady_clock::now();
+    auto stdio_graph = LoadTopologyWithStdio(pn_topology_filename.c_str());
+    double stdio_load_time = SecondsSince(start);
+    if (!stdio_graph || stdio_graph->edge_count() != graph->edge_count()) {
+      printf("The stdio loader read a different topology\n");
+      return 1;
+    }
+    printf("Load %.1lf MB: stdio %.3lf ms (%.1lf MB/s), mmap %.3lf ms "
+           "(%.1lf MB/s), speedup %.2lf\n",
+           megabytes, stdio_load_time * 1e3, megabytes / stdio_load_time,
+           graph_build_time * 1e3, megabytes / graph_build_time,
+           stdio_load_time / graph_build_time);
+  }
+  start = std::chrono::steady_clock::now();
+  CompactGraph compact_graph(*graph);
+  double compact_build_time = SecondsSince(start);
+  printf("%d nodes, %d links\n", graph->node_count(), graph->edge_count());
+  printf("Build: adjacency list %.3lf ms, CSR copy %.3lf ms\n",
+         graph_build_time * 1e3, compact_build_time * 1e3);
+
+  long adjacency_checksum = 0, compact_checksum = 0;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    adjacency_checksum += TraverseAdjacencyList(*graph);
+  }
+  double adjacency_time = SecondsSince(start) / repetitions;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repetitions; ++i) {
+    compact_checksum += TraverseCompactGraph(compact_graph);
+  }
+  double compact_time = SecondsSince(start) / repetitions;
+  if (adjacency_checksum != compact_checksum) {
+    printf("Checksum mismatch: %ld != %ld\n", adjacency_checksum,
+           compact_checksum);
+    return 1;
+  }
+  printf("Traversal: adjacency list %.3lf ms, CSR copy %.3lf ms, "
+         "speedup %.2lf\n",
+         adjacency_time * 1e3, compact_time * 1e3,
+         adjacency_time / compact_time);
+  return 0;
+}
@@ -2,17 +2,24 @@
 #define IO_H_
 
 #include "datastructure.h"
+#include "snapshot.h"
 #include "util.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <map>
 #include <memory>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-std::unique_ptr<std::map<std::string, std::string> > ParseArgs(int argc,
-                                                               char *argv[]) {
+inline std::unique_ptr<std::map<std::string, std::string> > ParseArgs(
+    int argc, char *argv[]) {
   std::unique_ptr<std::map<std::string, std::string> > arg_map(
       new std::map<std::string, std::string>());
   for (int i = 1; i < argc; ++i) {
@@ -24,68 +31,250 @@ std::unique_ptr<std::map<std::string, std::string> > ParseArgs(int argc,
   return std::move(arg_map);
 }
 
-std::unique_ptr<std::vector<std::vector<std::string> > > ReadCSVFile(
+// Read-only contents of a file. Regular files are memory mapped, anything
+// else, e.g., a pipe, is read into memory.
+class MappedFile {
+ public:
+  explicit MappedFile(const char *filename)
+      : data_(NULL), size_(0), is_mapped_(false), is_open_(false) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+      void *address = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (address != MAP_FAILED) {
+        madvise(address, info.st_size, MADV_SEQUENTIAL);
+        data_ = static_cast<const char *>(address);
+        size_ = info.st_size;
+        is_mapped_ = is_open_ = true;
+        close(fd);
+        return;
+      }
+    }
+    char buffer[1 << 16];
+    ssize_t bytes;
+    while ((bytes = read(fd, buffer, sizeof(buffer))) > 0) {
+      buffer_.append(buffer, bytes);
+    }
+    close(fd);
+    if (bytes < 0) return;
+    data_ = buffer_.data();
+    size_ = buffer_.size();
+    is_open_ = true;
+  }
+
+  ~MappedFile() {
+    if (is_mapped_) munmap(const_cast<char *>(data_), size_);
+  }
+
+  bool is_open() const { return is_open_; }
+  const char *data() const { return data_; }
+  size_t size() const { return size_; }
+
+ private:
+  MappedFile(const MappedFile &);
+  MappedFile &operator=(const MappedFile &);
+
+  const char *data_;
+  size_t size_;
+  std::string buffer_;
+  bool is_mapped_, is_open_;
+};
+
+// Single pass over the rows of a file of comma separated integers, which are
+// converted straight from the mapped file without intermediate strings.
+// Lines can be of any length, blank lines are skipped and spaces around
+// fields are ignored.
+class IntegerCSVReader {
+ public:
+  explicit IntegerCSVReader(const char *filename)
+      : filename_(filename), file_(filename), line_number_(0) {
+    position_ = file_.data();
+    end_ = position_ + file_.size();
+    if (!file_.is_open()) error_ = strerror(errno);
+  }
+
+  bool is_open() const { return file_.is_open(); }
+  const MappedFile &file() const { return file_; }
+  int line_number() const { return line_number_; }
+  const std::string &error() const { return error_; }
+
+  // Reads the next row into *fields. Returns false at the end of the file
+  // and on a malformed row, in which case error() is not empty.
+  bool NextRow(std::vector<long> *fields) {
+    fields->clear();
+    if (!error_.empty()) return false;
+    while (position_ < end_) {
+      const char *p = position_;
+      ++line_number_;
+      while (p < end_ && IsSpace(*p)) ++p;
+      if (p == end_ || IsLineEnd(*p)) {
+        position_ = SkipLine(p);
+        continue;
+      }
+      while (true) {
+        while (p < end_ && IsSpace(*p)) ++p;
+        bool is_negative = p < end_ && *p == '-';
+        if (p < end_ && (*p == '-' || *p == '+')) ++p;
+        if (p == end_ || *p < '0' || *p > '9') {
+          return Fail("expected an integer in field %d",
+                      static_cast<int>(fields->size()) + 1);
+        }
+        long value = 0;
+        for (; p < end_ && *p >= '0' && *p <= '9'; ++p) {
+          if (value > (LONG_MAX - (*p - '0')) / 10) {
+            return Fail("integer out of range in field %d",
+                        static_cast<int>(fields->size()) + 1);
+          }
+          value = value * 10 + (*p - '0');
+        }
+        fields->push_back(is_negative ? -value : value);
+        while (p < end_ && IsSpace(*p)) ++p;
+        if (p == end_ || IsLineEnd(*p)) break;
+        if (*p != ',') {
+          return Fail("unexpected '%c' after field %d", *p,
+                      static_cast<int>(fields->size()));
+        }
+        ++p;
+      }
+      position_ = SkipLine(p);
+      return true;
+    }
+    return false;
+  }
+
+  // Marks the current row as malformed and prints where and why.
+  template <typename... Args>
+  bool Fail(const char *format, Args... args) {
+    char message[256];
+    snprintf(message, sizeof(message), format, args...);
+    error_ = message;
+    printf("%s:%d: %s\n", filename_.c_str(), line_number_, message);
+    return false;
+  }
+
+ private:
+  static bool IsSpace(char c) { return c == ' ' || c == '\t'; }
+  static bool IsLineEnd(char c) { return c == '\n' || c == '\r'; }
+
+  // Returns the start of the line after the one p is on.
+  const char *SkipLine(const char *p) const {
+    const char *newline =
+        static_cast<const char *>(memchr(p, '\n', end_ - p));
+    return newline ? newline + 1 : end_;
+  }
+
+  std::string filename_;
+  MappedFile file_;
+  const char *position_, *end_;
+  int line_number_;
+  std::string error_;
+};
+
+// Splits every non-blank line of filename at the commas. Returns NULL if the
+// file cannot be read.
+inline std::unique_ptr<std::vector<std::vector<std::string> > > ReadCSVFile(
     const char *filename) {
   DEBUG("[Parsing %s]\n", filename);
-  FILE *file_ptr = fopen(filename, "r");
-  const static int kBufferSize = 1024;
-  char line_buffer[kBufferSize];
+  MappedFile file(filename);
+  if (!file.is_open()) {
+    printf("Cannot read %s: %s\n", filename, strerror(errno));
+    return nullptr;
+  }
   std::unique_ptr<std::vector<std::vector<std::string> > > ret_vector(
       new std::vector<std::vector<std::string> >());
-  std::vector<std::string> current_line;
-  int row_number = 0;
-  while (fgets(line_buffer, kBufferSize, file_ptr)) {
-    DEBUG("Read %d characters\n", strlen(line_buffer));
-    if (strlen(line_buffer) <= 0) continue;
-    if (line_buffer[0] == '\n' || line_buffer[0] == '\r') continue;
-    current_line.clear();
-    char *token = strtok(line_buffer, ",\n\r");
-    current_line.push_back(token);
-    while ((token = strtok(NULL, ",\n"))) {
-      current_line.push_back(token);
+  const char *p = file.data(), *end = p + file.size();
+  while (p < end) {
+    const char *line_end =
+        static_cast<const char *>(memchr(p, '\n', end - p));
+    if (!line_end) line_end = end;
+    const char *content_end = line_end;
+    if (content_end > p && content_end[-1] == '\r') --content_end;
+    if (content_end > p) {
+      std::vector<std::string> current_line;
+      while (true) {
+        const char *comma =
+            static_cast<const char *>(memchr(p, ',', content_end - p));
+        if (!comma) comma = content_end;
+        if (comma > p) current_line.push_back(std::string(p, comma));
+        if (comma == content_end) break;
+        p = comma + 1;
+      }
+      ret_vector->push_back(current_line);
     }
-    ret_vector->push_back(current_line);
+    p = line_end + 1;
   }
-  fclose(file_ptr);
   DEBUG("Parsed %d lines\n", static_cast<int>(ret_vector->size()));
   return std::move(ret_vector);
 }
 
-std::unique_ptr<Graph> InitializeTopologyFromFile(const char *filename) {
-  int node_count = 0, edge_count = 0;
-  auto csv_vector = ReadCSVFile(filename);
+// Reads a topology in CSV format or a binary snapshot (see snapshot.h).
+// Returns NULL, after printing the reason, if filename cannot be read or has
+// a malformed row.
+inline std::unique_ptr<Graph> InitializeTopologyFromFile(
+    const char *filename) {
+  DEBUG("[Parsing %s]\n", filename);
+  IntegerCSVReader reader(filename);
+  if (!reader.is_open()) {
+    printf("Cannot read %s: %s\n", filename, reader.error().c_str());
+    return nullptr;
+  }
+  if (IsGraphSnapshot(reader.file().data(), reader.file().size())) {
+    return ReadGraphSnapshot(reader.file().data(), reader.file().size(),
+                             filename);
+  }
   std::unique_ptr<Graph> graph(new Graph());
-  for (int i = 0; i < csv_vector->size(); ++i) {
-    auto &row = csv_vector->at(i);
-
+  std::vector<long> row;
+  while (reader.NextRow(&row)) {
     // Each line has the following format:
     // LinkID, SourceID, DestinationID, PeerID, Cost, Bandwidth, Delay.
-    int u = atoi(row[1].c_str());
-    int v = atoi(row[2].c_str());
-    int cost = atoi(row[4].c_str());
-    long bw = atol(row[5].c_str());
-    int delay = atoi(row[6].c_str());
-
-    DEBUG("Line[%d]: u = %d, v = %d, cost = %d, bw = %ld, delay = %d\n", i, u,
-          v, cost, bw, delay);
+    if (row.size() < 7) {
+      reader.Fail("expected 7 fields, found %d", static_cast<int>(row.size()));
+      break;
+    }
+    if (row[1] < 0 || row[1] > INT_MAX || row[2] < 0 || row[2] > INT_MAX) {
+      reader.Fail("invalid link endpoints %ld, %ld", row[1], row[2]);
+      break;
+    }
+    int u = row[1], v = row[2], cost = row[4], delay = row[6];
+    long bw = row[5];
+    DEBUG("Line[%d]: u = %d, v = %d, cost = %d, bw = %ld, delay = %d\n",
+          reader.line_number(), u, v, cost, bw, delay);
     graph->add_edge(u, v, bw, delay, cost);
   }
+  if (!reader.error().empty()) return nullptr;
   return std::move(graph);
 }
 
-std::unique_ptr<std::vector<std::vector<int> > > InitializeVNLocationsFromFile(
-    const char *filename, int num_virtual_nodes) {
+// Returns NULL, after printing the reason, if filename cannot be read or has
+// a malformed row, e.g., a location that is not one of num_physical_nodes.
+inline std::unique_ptr<std::vector<std::vector<int> > >
+InitializeVNLocationsFromFile(const char *filename, int num_virtual_nodes,
+                              int num_physical_nodes = INT_MAX) {
   DEBUG("Parsing %s\n", filename);
+  IntegerCSVReader reader(filename);
+  if (!reader.is_open()) {
+    printf("Cannot read %s: %s\n", filename, reader.error().c_str());
+    return nullptr;
+  }
   auto ret_vector = std::unique_ptr<std::vector<std::vector<int> > >(
       new std::vector<std::vector<int> >(num_virtual_nodes));
-  auto csv_vector = ReadCSVFile(filename);
-  for (int i = 0; i < csv_vector->size(); ++i) {
-    auto &row = csv_vector->at(i);
-    int vnode_id = atoi(row[0].c_str());
+  std::vector<long> row;
+  while (reader.NextRow(&row)) {
+    if (row[0] < 0 || row[0] >= num_virtual_nodes) {
+      reader.Fail("virtual node %ld out of range", row[0]);
+      break;
+    }
+    auto &locations = ret_vector->at(row[0]);
     for (int j = 1; j < row.size(); ++j) {
-      ret_vector->at(vnode_id).push_back(atoi(row[j].c_str()));
+      if (row[j] < 0 || row[j] >= num_physical_nodes) {
+        reader.Fail("invalid physical node %ld", row[j]);
+        break;
+      }
+      locations.push_back(row[j]);
     }
   }
+  if (!reader.error().empty()) return nullptr;
   return std::move(ret_vector);
 }
 
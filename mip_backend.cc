@@ -0,0 +1,67 @@
+#include "mip_backend.h"
+#include "bnb_backend.h"
+#ifdef USE_CPLEX
+#include "cplex_backend.h"
+#endif
+
+#include <stdlib.h>
+
+#ifdef USE_CPLEX
+const char *kDefaultMIPBackend = "cplex";
+#else
+const char *kDefaultMIPBackend = "bnb";
+#endif
+
+std::unique_ptr<MIPBackend> CreateMIPBackend(const std::string &name) {
+#ifdef USE_CPLEX
+  if (name == "cplex") return std::unique_ptr<MIPBackend>(new CPLEXBackend());
+#endif
+  if (name == "bnb") {
+    return std::unique_ptr<MIPBackend>(new BranchAndBoundBackend());
+  }
+  return std::unique_ptr<MIPBackend>();
+}
+
+bool ParseMIPParameter(const std::string &option, const std::string &value,
+                       MIPParameters *parameters) {
+  const char *str = value.c_str();
+  char *end = NULL;
+  if (option == "--threads") {
+    parameters->threads = strtol(str, &end, 10);
+    return *str && !*end && parameters->threads >= 0;
+  } else if (option == "--time_limit") {
+    parameters->time_limit = strtod(str, &end);
+    return *str && !*end && parameters->time_limit >= 0.0;
+  } else if (option == "--mip_gap") {
+    parameters->mip_gap = strtod(str, &end);
+    return *str && !*end && parameters->mip_gap >= 0.0;
+  } else if (option == "--node_file") {
+    const char *kNodeFileModes[] = {"none", "memory", "disk",
+                                    "compressed_disk"};
+    for (int mode = 0; mode < 4; ++mode) {
+      if (value == kNodeFileModes[mode]) {
+        parameters->node_file = mode;
+        return true;
+      }
+    }
+    return false;
+  } else if (option == "--tree_memory_limit") {
+    parameters->tree_memory_limit = strtod(str, &end);
+    return *str && !*end && parameters->tree_memory_limit >= 0.0;
+  } else if (option == "--work_memory") {
+    parameters->work_memory = strtod(str, &end);
+    return *str && !*end && parameters->work_memory >= 0.0;
+  } else if (option == "--parallel_mode") {
+    if (value == "opportunistic") {
+      parameters->parallel_mode = -1;
+    } else if (value == "auto") {
+      parameters->parallel_mode = 0;
+    } else if (value == "deterministic") {
+      parameters->parallel_mode = 1;
+    } else {
+      return false;
+    }
+    return true;
+  }
+  return false;
+}
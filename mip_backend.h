@@ -0,0 +1,195 @@
+#ifndef MIP_BACKEND_H_
+#define MIP_BACKEND_H_
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define MIP_INFINITY 1e20
+
+enum VariableType { kContinuous, kInteger, kBinary };
+enum ConstraintSense { kLessEqual, kGreaterEqual, kEqual };
+
+// A linear expression sum(coefficient * variable) + constant. Variables are
+// identified by the ids returned by MIPBackend::AddVariable.
+struct LinearExpr {
+  std::vector<std::pair<int, double> > terms;
+  double constant;
+  LinearExpr() : constant(0.0) {}
+  void AddTerm(int variable, double coefficient) {
+    terms.push_back(std::make_pair(variable, coefficient));
+  }
+  void Add(const LinearExpr &expr, double scale) {
+    for (auto &term : expr.terms)
+      terms.push_back(std::make_pair(term.first, term.second * scale));
+    constant += expr.constant * scale;
+  }
+};
+
+// A constraint of the form expr (<=, >=, ==) rhs.
+struct LinearConstraint {
+  LinearExpr expr;
+  ConstraintSense sense;
+  double rhs;
+  LinearConstraint() : sense(kLessEqual), rhs(0.0) {}
+  LinearConstraint(const LinearExpr &expr, ConstraintSense sense, double rhs)
+      : expr(expr), sense(sense), rhs(rhs) {}
+};
+
+// Solver parameters. Backends ignore the parameters they do not support.
+struct MIPParameters {
+  // Number of threads, or 0 to let the backend decide.
+  int threads;
+  // Limit on the solve time in seconds, or 0 for no limit.
+  double time_limit;
+  // Relative gap between the best solution and the best bound at which the
+  // search stops, or a negative value for the backend's default.
+  double mip_gap;
+  // Where nodes of the search tree go once tree_memory_limit is reached, as
+  // the CPLEX parameter NodeFileInd: 0 nowhere (the search stops), 1 memory
+  // (compressed), 2 disk, 3 disk (compressed); -1 for the backend's default.
+  int node_file;
+  // Memory in MB for the search tree and for working storage, or 0 for the
+  // backend's default.
+  double tree_memory_limit;
+  double work_memory;
+  // -1 opportunistic, 0 automatic, 1 deterministic parallel search.
+  int parallel_mode;
+  MIPParameters()
+      : threads(0),
+        time_limit(0.0),
+        mip_gap(-1.0),
+        node_file(-1),
+        tree_memory_limit(0.0),
+        work_memory(0.0),
+        parallel_mode(0) {}
+};
+
+// Interface of a mixed integer programming solver. VNEProtectionSolver
+// describes the 1 + 1 protection model only in terms of this interface, so
+// the model can be solved by any backend implementing it.
+class MIPBackend {
+ public:
+  virtual ~MIPBackend() {}
+
+  virtual const char *name() const = 0;
+
+  // Adds a variable with bounds [lb, ub] and returns its id. Ids are assigned
+  // consecutively starting from 0.
+  virtual int AddVariable(double lb, double ub, VariableType type) = 0;
+
+  // Adds a linear constraint to the model and returns its id. Ids of linear
+  // constraints are assigned consecutively starting from 0.
+  virtual int AddConstraint(const LinearConstraint &constraint) = 0;
+
+  // Sets the coefficient of variable, which must not occur in it yet, and
+  // the right-hand side of the linear constraint with id constraint. They
+  // let a model that is solved repeatedly be modified instead of rebuilt.
+  virtual void SetCoefficient(int constraint, int variable,
+                              double coefficient) = 0;
+  virtual void SetRHS(int constraint, double rhs) = 0;
+  // Changes the bounds of variable to [lb, ub], e.g., to fix it temporarily
+  // without adding a constraint.
+  virtual void SetBounds(int variable, double lb, double ub) = 0;
+
+  // Adds the constraint "variable == value implies constraint". variable must
+  // be a binary variable and value either 0 or 1.
+  virtual void AddIndicatorConstraint(int variable, int value,
+                                      const LinearConstraint &constraint) = 0;
+
+  // Adds a linear constraint that is only enforced once a candidate solution
+  // violates it, which keeps the relaxations small if few of many similar
+  // constraints are ever binding. Lazy constraints get no id and are only
+  // counted by num_lazy_constraints().
+  virtual void AddLazyConstraint(const LinearConstraint &constraint) = 0;
+
+  // Sets a minimization objective.
+  virtual void SetObjective(const LinearExpr &objective) = 0;
+
+  // Sets the branching priority of an integer variable. Fractional variables
+  // with a higher priority are branched on first; the default is 0.
+  virtual void SetPriority(int variable, int priority) = 0;
+
+  // Provides a starting solution as (variable, value) pairs, e.g., one found
+  // by a heuristic. Backends may complete a partial assignment or reject an
+  // infeasible one.
+  virtual void SetMIPStart(
+      const std::vector<std::pair<int, double> > &values) = 0;
+
+  // Only solutions with an objective of at most cutoff are of interest; the
+  // search discards everything worse.
+  virtual void SetCutoff(double cutoff) = 0;
+
+  // RollBack() removes the variables and constraints, including lazy ones,
+  // added since the last call to SetRollBackPoint(), and their coefficients
+  // in the remaining constraints. It also clears the objective, the MIP start
+  // and the cutoff, so that the rest of the model can be solved again with
+  // another extension.
+  virtual void SetRollBackPoint() = 0;
+  virtual void RollBack() = 0;
+
+  // Sets the parameters of subsequent calls to Solve().
+  virtual void SetParameters(const MIPParameters &parameters) = 0;
+
+  // Writes the model to filename in CPLEX LP format, compressed with gzip if
+  // filename ends with ".gz". Returns false if the file cannot be written.
+  virtual bool ExportModel(const char *filename) = 0;
+
+  // Solves the model. Returns true if a feasible solution has been found.
+  virtual bool Solve() = 0;
+
+  // Solves the LP relaxation of the model, i.e., without integrality and
+  // lazy constraints, and stores the value of every variable and the dual
+  // value of every linear constraint of an optimal solution, indexed by id.
+  // Duals of <= constraints are at most 0, those of >= constraints at least
+  // 0. The model must not contain indicator constraints. Returns false if no
+  // optimal solution has been found. Column generation prices new variables
+  // with the duals.
+  virtual bool SolveRelaxation(std::vector<double> *values,
+                               std::vector<double> *duals) = 0;
+
+  // Returns the solution status in the vocabulary of IloAlgorithm::Status,
+  // e.g., "Optimal", "Feasible", "Infeasible", "Unknown".
+  virtual std::string GetStatus() = 0;
+
+  // Value of a variable and of the objective in the best solution found.
+  virtual double GetValue(int variable) = 0;
+  // Values of all variables in the best solution found, indexed by variable
+  // id. Much faster than a GetValue call per variable.
+  virtual void GetValues(std::vector<double> *values) = 0;
+  virtual double GetObjValue() = 0;
+
+  // Seconds from the start of Solve() until the first feasible solution was
+  // found (including an accepted MIP start), or a negative value if none was
+  // found.
+  virtual double GetFirstIncumbentTime() = 0;
+
+  // Lower bound on the objective at the root node of the search, i.e., the
+  // LP relaxation after the backend's preprocessing, or -MIP_INFINITY if the
+  // root has not been solved.
+  virtual double GetRootBound() = 0;
+
+  // Number of branch-and-bound nodes processed by the last call to Solve().
+  virtual long GetNodeCount() = 0;
+
+  virtual int num_variables() const = 0;
+  virtual int num_constraints() const = 0;
+  virtual int num_lazy_constraints() const = 0;
+};
+
+// Name of the backend used when none is given on the command line.
+extern const char *kDefaultMIPBackend;
+
+// Returns a new backend with the given name ("cplex" or "bnb"), or a null
+// pointer if the backend does not exist or was not compiled in.
+std::unique_ptr<MIPBackend> CreateMIPBackend(const std::string &name);
+
+// Sets the parameter for the command line option "--<option>=<value>", i.e.,
+// one of --threads, --time_limit, --mip_gap, --node_file, --tree_memory_limit,
+// --work_memory and --parallel_mode. Returns false if option is not one of
+// them or value is invalid.
+bool ParseMIPParameter(const std::string &option, const std::string &value,
+                       MIPParameters *parameters);
+
+#endif  // MIP_BACKEND_H_
@@ -0,0 +1,38 @@
+# Summarizes the run profiles that vne_protection appends to --profile_file
+# (see README.md): prints one CSV line per run with its size, its peak
+# resident set size and the wall time of every phase, ordered by the size of
+# the physical network so that regressions on large substrates stand out.
+import argparse
+import json
+
+PHASES = ["parse", "shadow_topology", "variables", "build_model", "export",
+          "mip_start", "solve", "extract", "write"]
+
+def main():
+    parser = argparse.ArgumentParser(
+            description = "Summarizes vne_protection run profiles",
+            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--profile_file',
+            help='File written by --profile_file', required=True)
+    args = parser.parse_args()
+    with open(args.profile_file) as f:
+        runs = [json.loads(line) for line in f if line.strip()]
+    runs.sort(key=lambda run: (run.get("pn_nodes", 0), run.get("pn_links", 0)))
+    print ("pn_topology_file,vn_topology_file,pn_nodes,pn_links,status," +
+           "variables,constraints,peak_rss_kb,wall_time,cpu_time," +
+           ",".join(phase + "_time" for phase in PHASES))
+    for run in runs:
+        phases = dict((phase["name"], phase) for phase in run["phases"])
+        model = max([(phase["variables"], phase["constraints"])
+                     for phase in run["phases"]] or [(0, 0)])
+        columns = [run.get("pn_topology_file", ""),
+                   run.get("vn_topology_file", run.get("vn_list_file", "")),
+                   run.get("pn_nodes", ""), run.get("pn_links", ""),
+                   run.get("status", ""), model[0], model[1],
+                   run["peak_rss_kb"], run["wall_time"], run["cpu_time"]]
+        columns += [phases[phase]["wall_time"] if phase in phases else ""
+                    for phase in PHASES]
+        print ",".join(str(column) for column in columns)
+
+if __name__ == "__main__":
+    main()
@@ -4,11 +4,15 @@ import os
 import subprocess
 
 def execute_one_experiment(executable, pn_topology_file, vn_topology_file,
-        location_constraint_file, vnr_root):
+        location_constraint_file, vnr_root, profile_file):
+    extra_args = []
+    if profile_file:
+        extra_args.append('--profile_file=' + profile_file)
     process = subprocess.Popen([executable, '--pn_topology_file=' +
             pn_topology_file, '--vn_topology_file=' + vn_topology_file,
-            '--location_constraint_file=' + location_constraint_file],
-            stdout=subprocess.PIPE, stderr=subprocess.PIPE, shell=False)
+            '--location_constraint_file=' + location_constraint_file] +
+            extra_args, stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+            shell=False)
     # solution_time = process.stdout.readline().split(':')[1][1:].rstrip('\n')
     out, err = process.communicate()
     with open(os.path.join(vnr_root, "stdout"), 'w') as f:
@@ -29,6 +33,9 @@ def main():
           '--executable', 
           help='Name of the executable file to run',
           required=True)
+  parser.add_argument(
+          '--profile_file',
+          help='File the run profile of every test case is appended to')
   args = parser.parse_args()
   root = args.testcase_root
   executable = './' + args.executable
@@ -46,7 +53,7 @@ def main():
           vn_topology_file = os.path.join(path, "vn.txt")
           location_constraint_file = os.path.join(path, "vnloc.txt")
           execute_one_experiment(executable, pn_topology_file, vn_topology_file,
-                  location_constraint_file, path)
+                  location_constraint_file, path, args.profile_file)
       else:
           for vnr_root in vnr_dirs:
               vnr_types = tuple(os.walk(os.path.join(path, vnr_root)))[0][1]
@@ -58,7 +65,8 @@ def main():
                     vn_topology_file = os.path.join(vnr_r, "vn.txt")
                     location_constraint_file = os.path.join(vnr_r, "vnloc.txt")
                     execute_one_experiment(executable, pn_topology_file,
-                            vn_topology_file, location_constraint_file, vnr_r)
+                            vn_topology_file, location_constraint_file, vnr_r,
+                            args.profile_file)
 
                   
 
@@ -0,0 +1,98 @@
+#include "run_profile.h"
+#include "util.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+double GetTime(clockid_t clock) {
+  struct timespec now;
+  clock_gettime(clock, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+std::string QuoteJSON(const std::string &str) {
+  std::string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+std::string FormatNumber(const char *fmt_string, double value) {
+  char buffer[64];
+  snprintf(buffer, sizeof(buffer), fmt_string, value);
+  return buffer;
+}
+
+}  // namespace
+
+RunProfile::RunProfile()
+    : start_wall_time_(GetTime(CLOCK_MONOTONIC)),
+      start_cpu_time_(GetTime(CLOCK_PROCESS_CPUTIME_ID)),
+      phase_wall_time_(start_wall_time_),
+      phase_cpu_time_(start_cpu_time_) {}
+
+void RunProfile::StartPhase(const std::string &name) {
+  if (!phase_name_.empty()) EndPhase();
+  phase_name_ = name;
+  phase_wall_time_ = GetTime(CLOCK_MONOTONIC);
+  phase_cpu_time_ = GetTime(CLOCK_PROCESS_CPUTIME_ID);
+}
+
+void RunProfile::EndPhase(int variables, int constraints) {
+  if (phase_name_.empty()) return;
+  PhaseProfile phase = {phase_name_,
+                        GetTime(CLOCK_MONOTONIC) - phase_wall_time_,
+                        GetTime(CLOCK_PROCESS_CPUTIME_ID) - phase_cpu_time_,
+                        GetPeakMemoryUsageKB(), variables, constraints};
+  phases_.push_back(phase);
+  phase_name_.clear();
+}
+
+void RunProfile::AddField(const std::string &key, const std::string &value) {
+  fields_.push_back(std::make_pair(key, QuoteJSON(value)));
+}
+
+void RunProfile::AddField(const std::string &key, double value) {
+  fields_.push_back(std::make_pair(key, FormatNumber("%.15g", value)));
+}
+
+std::string RunProfile::ToJSON() const {
+  std::string json = "{";
+  for (auto &field : fields_) {
+    json += QuoteJSON(field.first) + ": " + field.second + ", ";
+  }
+  json += "\"wall_time\": " +
+          FormatNumber("%.6lf", GetTime(CLOCK_MONOTONIC) - start_wall_time_);
+  json += ", \"cpu_time\": " +
+          FormatNumber("%.6lf",
+                       GetTime(CLOCK_PROCESS_CPUTIME_ID) - start_cpu_time_);
+  json += ", \"peak_rss_kb\": " +
+          FormatNumber("%.0lf", GetPeakMemoryUsageKB());
+  json += ", \"phases\": [";
+  for (int i = 0; i < phases_.size(); ++i) {
+    auto &phase = phases_[i];
+    if (i > 0) json += ", ";
+    json += "{\"name\": " + QuoteJSON(phase.name);
+    json += ", \"wall_time\": " + FormatNumber("%.6lf", phase.wall_time);
+    json += ", \"cpu_time\": " + FormatNumber("%.6lf", phase.cpu_time);
+    json += ", \"peak_rss_kb\": " + FormatNumber("%.0lf", phase.peak_rss_kb);
+    json += ", \"variables\": " + FormatNumber("%.0lf", phase.variables);
+    json += ", \"constraints\": " + FormatNumber("%.0lf", phase.constraints);
+    json += "}";
+  }
+  return json + "]}\n";
+}
+
+bool RunProfile::AppendTo(const std::string &filename) const {
+  int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd < 0) return false;
+  std::string json = ToJSON();
+  bool is_success = write(fd, json.data(), json.size()) == json.size();
+  return close(fd) == 0 && is_success;
+}
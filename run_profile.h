@@ -0,0 +1,59 @@
+#ifndef RUN_PROFILE_H_
+#define RUN_PROFILE_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+// Wall time, CPU time of all threads of the process, peak resident set size
+// and model size at the end of one phase of a run, e.g., building the model.
+struct PhaseProfile {
+  std::string name;
+  double wall_time;
+  double cpu_time;
+  long peak_rss_kb;
+  int variables;
+  int constraints;
+};
+
+// Measures the phases of a run one after the other and writes them, together
+// with fields that describe the run, as one JSON line:
+//
+// {"<field>": ..., ..., "wall_time": ..., "cpu_time": ..., "peak_rss_kb": ...,
+//  "phases": [{"name": ..., "wall_time": ..., "cpu_time": ...,
+//              "peak_rss_kb": ..., "variables": ..., "constraints": ...}, ...]}
+//
+// Times are in seconds; the totals run from the construction of the profile.
+class RunProfile {
+ public:
+  RunProfile();
+
+  // Ends the current phase, if any, and starts the phase called name.
+  void StartPhase(const std::string &name);
+  // Ends the current phase with the number of variables and constraints of
+  // the model at that point.
+  void EndPhase(int variables = 0, int constraints = 0);
+
+  void AddField(const std::string &key, const std::string &value);
+  void AddField(const std::string &key, double value);
+
+  const std::vector<PhaseProfile> &phases() const { return phases_; }
+
+  std::string ToJSON() const;
+  // Appends the JSON line to filename with a single write, so that processes
+  // that profile their runs concurrently can share the file. Returns false if
+  // it cannot be written.
+  bool AppendTo(const std::string &filename) const;
+
+ private:
+  double start_wall_time_;
+  double start_cpu_time_;
+  double phase_wall_time_;
+  double phase_cpu_time_;
+  std::string phase_name_;
+  // Keys and their values already formatted as JSON.
+  std::vector<std::pair<std::string, std::string> > fields_;
+  std::vector<PhaseProfile> phases_;
+};
+
+#endif  // RUN_PROFILE_H_
@@ -0,0 +1,159 @@
+# Runs the embedding pipeline on synthetic instances of growing size: for
+# every size of the ladder vne_generator writes a physical network and a few
+# virtual network requests, vne_protection embeds each request with
+# --profile_file, and the profiles are summarized per size as CSV, i.e., the
+# mean model build, solve and extraction times, the model size and the peak
+# resident set size. With --chart the same numbers are drawn on log-log axes
+# into an SVG file.
+import argparse
+import json
+import math
+import os
+import subprocess
+
+PHASE_GROUPS = [("build", ["shadow_topology", "variables", "build_model"]),
+                ("solve", ["mip_start", "column_generation", "solve"]),
+                ("extract", ["extract", "write"])]
+COLORS = ["#1f77b4", "#d62728", "#2ca02c"]
+
+def generate(generator, model, nodes, requests, seed, directory, extra_args):
+    subprocess.check_call([generator, '--model=' + model,
+            '--nodes=' + str(nodes), '--requests=' + str(requests),
+            '--seed=' + str(seed), '--output_directory=' + directory] +
+            extra_args, stdout=subprocess.PIPE)
+
+def embed(executable, directory, request, profile_file, extra_args):
+    vn_topology_file = os.path.join(directory, "vnr", "vn%d" % request)
+    with open(vn_topology_file + ".stdout", 'w') as f:
+        subprocess.call([executable, '--pn_topology_file=' +
+                os.path.join(directory, "sn.txt"),
+                '--vn_topology_file=' + vn_topology_file,
+                '--location_constraint_file=' + vn_topology_file + "loc",
+                '--profile_file=' + profile_file] + extra_args,
+                stdout=f, stderr=subprocess.STDOUT)
+
+def summarize(runs):
+    mean = lambda values: sum(values) / float(len(values))
+    row = {"pn_nodes": runs[0]["pn_nodes"], "pn_links": runs[0]["pn_links"],
+           "runs": len(runs),
+           "peak_rss_kb": max(run["peak_rss_kb"] for run in runs)}
+    row["variables"] = mean([max([0] + [phase["variables"]
+            for phase in run["phases"]]) for run in runs])
+    row["constraints"] = mean([max([0] + [phase["constraints"]
+            for phase in run["phases"]]) for run in runs])
+    for group, phases in PHASE_GROUPS:
+        row[group + "_time"] = mean([sum(phase["wall_time"]
+                for phase in run["phases"] if phase["name"] in phases)
+                for run in runs])
+    return row
+
+def write_chart(rows, filename):
+    width, height, margin = 420, 320, 60
+    def panel(x_offset, title, series):
+        points = [(x, y) for _, values in series for x, y in values if y > 0]
+        if not points:
+            return []
+        x_range = [math.log10(min(p[0] for p in points)),
+                   math.log10(max(p[0] for p in points))]
+        y_range = [math.log10(min(p[1] for p in points)),
+                   math.log10(max(p[1] for p in points))]
+        for r in (x_range, y_range):
+            r[0], r[1] = math.floor(r[0]), max(math.ceil(r[1]), r[0] + 1)
+        def to_svg(x, y):
+            return (x_offset + margin + (math.log10(x) - x_range[0]) /
+                    (x_range[1] - x_range[0]) * (width - 2 * margin),
+                    height - margin - (math.log10(y) - y_range[0]) /
+                    (y_range[1] - y_range[0]) * (height - 2 * margin))
+        svg = ['<text x="%d" y="30" font-weight="bold">%s</text>' %
+               (x_offset + margin, title),
+               '<rect x="%d" y="%d" width="%d" height="%d" fill="none" '
+               'stroke="black"/>' % (x_offset + margin, margin,
+                                     width - 2 * margin, height - 2 * margin)]
+        for exponent in range(int(x_range[0]), int(x_range[1]) + 1):
+            x, y = to_svg(10 ** exponent, 10 ** y_range[0])
+            svg.append('<text x="%.1f" y="%.1f" text-anchor="middle">1e%d'
+                       '</text>' % (x, y + 15, exponent))
+        for exponent in range(int(y_range[0]), int(y_range[1]) + 1):
+            x, y = to_svg(10 ** x_range[0], 10 ** exponent)
+            svg.append('<text x="%.1f" y="%.1f" text-anchor="end">1e%d'
+                       '</text>' % (x - 4, y + 4, exponent))
+        for i, (name, values) in enumerate(series):
+            line = " ".join("%.1f,%.1f" % to_svg(x, y)
+                            for x, y in values if y > 0)
+            svg.append('<polyline points="%s" fill="none" stroke="%s"/>' %
+                       (line, COLORS[i % len(COLORS)]))
+            svg.append('<text x="%d" y="%d" fill="%s">%s</text>' %
+                       (x_offset + width - margin + 4, margin + 15 * i + 10,
+                        COLORS[i % len(COLORS)], name))
+        svg.append('<text x="%d" y="%d">physical nodes</text>' %
+                   (x_offset + width / 2 - 40, height - 15))
+        return svg
+    times = [(group, [(row["pn_nodes"], row[group + "_time"]) for row in rows])
+             for group, _ in PHASE_GROUPS]
+    memory = [("rss", [(row["pn_nodes"], row["peak_rss_kb"]) for row in rows])]
+    svg = ['<svg xmlns="http://www.w3.org/2000/svg" width="%d" height="%d" '
+           'font-family="sans-serif" font-size="11">' %
+           (2 * width + 40, height)]
+    svg += panel(0, "Mean wall time (s)", times)
+    svg += panel(width + 40, "Peak RSS (KB)", memory)
+    svg.append('</svg>')
+    with open(filename, 'w') as f:
+        f.write("\n".join(svg) + "\n")
+
+def main():
+    parser = argparse.ArgumentParser(
+            description = "Measures how the embedding scales with the size "
+                          "of the physical network",
+            formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--sizes', default='100,200,500,1000,2000,5000',
+            help='Comma separated numbers of physical nodes')
+    parser.add_argument('--model', default='waxman',
+            help='Topology model passed to vne_generator')
+    parser.add_argument('--requests', type=int, default=3,
+            help='Virtual network requests embedded per size')
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--executable', default='vne_protection')
+    parser.add_argument('--generator', default='vne_generator')
+    parser.add_argument('--output_directory', default='scaling',
+            help='Directory the instances and profiles are written to')
+    parser.add_argument('--chart', help='SVG file to draw the results into')
+    parser.add_argument('--solver_args', default='',
+            help='Extra options of vne_protection, e.g., '
+                 '"--solver=heuristic" or "--time_limit=60"')
+    parser.add_argument('--generator_args', default='',
+            help='Extra options of vne_generator, e.g., "--max_vn_nodes=5"')
+    args = parser.parse_args()
+    executable = './' + args.executable
+    generator = './' + args.generator
+    profile_file = os.path.join(args.output_directory, "profile.jsonl")
+    if not os.path.isdir(args.output_directory):
+        os.makedirs(args.output_directory)
+    if os.path.exists(profile_file):
+        os.remove(profile_file)
+    rows = []
+    for nodes in [int(size) for size in args.sizes.split(",")]:
+        directory = os.path.join(args.output_directory,
+                                 "%s-%d" % (args.model, nodes))
+        generate(generator, args.model, nodes, args.requests, args.seed,
+                 directory, args.generator_args.split())
+        first_run = 0
+        if os.path.exists(profile_file):
+            with open(profile_file) as f:
+                first_run = len(f.readlines())
+        for request in range(args.requests):
+            embed(executable, directory, request, profile_file,
+                  args.solver_args.split())
+        with open(profile_file) as f:
+            runs = [json.loads(line) for line in f.readlines()[first_run:]]
+        if runs:
+            rows.append(summarize(runs))
+    columns = ["pn_nodes", "pn_links", "runs", "variables", "constraints",
+               "build_time", "solve_time", "extract_time", "peak_rss_kb"]
+    print ",".join(columns)
+    for row in rows:
+        print ",".join(str(row[column]) for column in columns)
+    if args.chart and rows:
+        write_chart(rows, args.chart)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,311 @@
+#include "snapshot.h"
+#include "io.h"
+
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+const char kGraphMagic[4] = {'V', 'N', 'E', 'G'};
+const char kEmbeddingMagic[4] = {'V', 'N', 'E', 'E'};
+
+static_assert(sizeof(GraphSnapshotHeader) == 16, "unexpected padding");
+static_assert(sizeof(LinkRecord) == 24, "unexpected padding");
+static_assert(sizeof(EmbeddingSnapshotHeader) == 56, "unexpected padding");
+static_assert(sizeof(NodeMappingRecord) == 8, "unexpected padding");
+static_assert(sizeof(LinkMappingRecord) == 20, "unexpected padding");
+
+// Orders the links of graph such that adding them one by one reproduces its
+// adjacency lists: a link is taken once it is the next unvisited edge in the
+// adjacency lists of both its end points. Returns false if the lists cannot
+// be reproduced, which only happens with self loops.
+bool GetLinkRecords(const Graph &graph, std::vector<LinkRecord> *links) {
+  auto &adj_list = *graph.adj_list();
+  std::vector<int> next(graph.node_count(), 0), worklist;
+  for (int u = graph.node_count() - 1; u >= 0; --u) worklist.push_back(u);
+  links->clear();
+  while (!worklist.empty()) {
+    int u = worklist.back();
+    worklist.pop_back();
+    while (next[u] < adj_list[u].size()) {
+      auto &end_point = adj_list[u][next[u]];
+      int v = end_point.node_id;
+      if (v == u || next[v] != end_point.reverse_index) break;
+      LinkRecord link = {u, v, end_point.cost, end_point.delay,
+                         end_point.bandwidth};
+      links->push_back(link);
+      ++next[u];
+      // Both v and the node v now waits for may be able to continue.
+      if (++next[v] < adj_list[v].size()) {
+        worklist.push_back(adj_list[v][next[v]].node_id);
+      }
+      worklist.push_back(v);
+    }
+  }
+  return links->size() == graph.edge_count();
+}
+
+bool WriteFile(const char *filename, const void *header, size_t header_size,
+               const std::vector<std::pair<const void *, size_t> > &blocks) {
+  FILE *outfile = fopen(filename, "wb");
+  if (!outfile) return false;
+  bool is_success = fwrite(header, header_size, 1, outfile) == 1;
+  for (auto &block : blocks) {
+    if (block.second > 0) {
+      is_success &= fwrite(block.first, block.second, 1, outfile) == 1;
+    }
+  }
+  return fclose(outfile) == 0 && is_success;
+}
+}  // namespace
+
+bool IsGraphSnapshot(const char *data, size_t size) {
+  return size >= sizeof(kGraphMagic) &&
+         memcmp(data, kGraphMagic, sizeof(kGraphMagic)) == 0;
+}
+
+std::unique_ptr<Graph> ReadGraphSnapshot(const char *data, size_t size,
+                                         const char *filename) {
+  GraphSnapshotHeader header;
+  if (size < sizeof(header)) {
+    printf("%s: truncated snapshot header\n", filename);
+    return nullptr;
+  }
+  memcpy(&header, data, sizeof(header));
+  if (memcmp(header.magic, kGraphMagic, sizeof(kGraphMagic)) ||
+      header.version != kSnapshotVersion) {
+    printf("%s: not a version %d topology snapshot\n", filename,
+           kSnapshotVersion);
+    return nullptr;
+  }
+  if (header.node_count < 0 || header.link_count < 0 ||
+      size != sizeof(header) + header.link_count * sizeof(LinkRecord)) {
+    printf("%s: expected %d links, found %ld bytes\n", filename,
+           header.link_count, static_cast<long>(size));
+    return nullptr;
+  }
+  // The records are read twice: first to validate them and size every
+  // adjacency list, then to add the links.
+  const char *records = data + sizeof(header);
+  std::vector<int> degree(header.node_count, 0);
+  LinkRecord link;
+  for (int i = 0; i < header.link_count; ++i) {
+    memcpy(&link, records + i * sizeof(LinkRecord), sizeof(link));
+    if (link.u < 0 || link.u >= header.node_count || link.v < 0 ||
+        link.v >= header.node_count) {
+      printf("%s: link %d has invalid end points %d, %d\n", filename, i,
+             link.u, link.v);
+      return nullptr;
+    }
+    ++degree[link.u];
+    ++degree[link.v];
+  }
+  std::unique_ptr<Graph> graph(new Graph());
+  graph->reserve(degree);
+  for (int i = 0; i < header.link_count; ++i) {
+    memcpy(&link, records + i * sizeof(LinkRecord), sizeof(link));
+    graph->add_edge(link.u, link.v, link.bandwidth, link.delay, link.cost);
+  }
+  return graph;
+}
+
+bool WriteGraphSnapshot(const Graph &graph, const char *filename) {
+  std::vector<LinkRecord> links;
+  if (!GetLinkRecords(graph, &links)) return false;
+  GraphSnapshotHeader header;
+  memcpy(header.magic, kGraphMagic, sizeof(kGraphMagic));
+  header.version = kSnapshotVersion;
+  header.node_count = graph.node_count();
+  header.link_count = links.size();
+  return WriteFile(filename, &header, sizeof(header),
+                   {std::make_pair(links.data(),
+                                   links.size() * sizeof(LinkRecord))});
+}
+
+bool WriteTopologyCSV(const Graph &graph, const char *filename) {
+  std::vector<LinkRecord> links;
+  if (!GetLinkRecords(graph, &links)) return false;
+  FILE *outfile = fopen(filename, "w");
+  if (!outfile) return false;
+  for (int i = 0; i < links.size(); ++i) {
+    fprintf(outfile, "%d,%d,%d,0,%d,%ld,%d\n", i, links[i].u, links[i].v,
+            links[i].cost, static_cast<long>(links[i].bandwidth),
+            links[i].delay);
+  }
+  return fclose(outfile) == 0;
+}
+
+bool ReadEmbeddingSnapshot(const char *filename, VNEmbedding *embedding) {
+  MappedFile file(filename);
+  EmbeddingSnapshotHeader header;
+  if (!file.is_open() || file.size() < sizeof(header)) return false;
+  memcpy(&header, file.data(), sizeof(header));
+  if (memcmp(header.magic, kEmbeddingMagic, sizeof(kEmbeddingMagic)) ||
+      header.version != kSnapshotVersion || header.node_count < 0 ||
+      header.link_count < 0 ||
+      file.size() != sizeof(header) +
+                         header.node_count * sizeof(NodeMappingRecord) +
+                         header.link_count * sizeof(LinkMappingRecord)) {
+    return false;
+  }
+  header.status[sizeof(header.status) - 1] = '\0';
+  *embedding = VNEmbedding();
+  embedding->status = header.status;
+  embedding->cost = header.cost;
+  const char *record = file.data() + sizeof(header);
+  for (int i = 0; i < header.node_count; ++i) {
+    NodeMappingRecord node;
+    memcpy(&node, record, sizeof(node));
+    record += sizeof(node);
+    embedding->node_map.push_back(node.node);
+    embedding->shadow_node_map.push_back(node.shadow_node);
+  }
+  for (int i = 0; i < header.link_count; ++i) {
+    LinkMappingRecord link;
+    memcpy(&link, record, sizeof(link));
+    record += sizeof(link);
+    auto &edge_map = link.is_shadow ? embedding->shadow_edge_map
+                                    : embedding->edge_map;
+    edge_map[std::make_pair(link.m, link.n)].push_back(
+        std::make_pair(link.u, link.v));
+  }
+  return true;
+}
+
+bool WriteEmbeddingSnapshot(const VNEmbedding &embedding,
+                            const char *filename) {
+  EmbeddingSnapshotHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kEmbeddingMagic, sizeof(kEmbeddingMagic));
+  header.version = kSnapshotVersion;
+  snprintf(header.status, sizeof(header.status), "%s",
+           embedding.status.c_str());
+  header.cost = embedding.cost;
+  std::vector<NodeMappingRecord> nodes;
+  for (int m = 0; m < embedding.node_map.size(); ++m) {
+    NodeMappingRecord node = {embedding.node_map[m],
+                              m < embedding.shadow_node_map.size()
+                                  ? embedding.shadow_node_map[m]
+                                  : NIL};
+    nodes.push_back(node);
+  }
+  std::vector<LinkMappingRecord> links;
+  for (int is_shadow = 0; is_shadow < 2; ++is_shadow) {
+    auto &edge_map = is_shadow ? embedding.shadow_edge_map
+                               : embedding.edge_map;
+    for (auto &entry : edge_map) {
+      for (auto &link : entry.second) {
+        LinkMappingRecord record = {entry.first.first, entry.first.second,
+                                    link.first, link.second, is_shadow};
+        links.push_back(record);
+      }
+    }
+  }
+  header.node_count = nodes.size();
+  header.link_count = links.size();
+  return WriteFile(
+      filename, &header, sizeof(header),
+      {std::make_pair(nodes.data(), nodes.size() * sizeof(NodeMappingRecord)),
+       std::make_pair(links.data(),
+                      links.size() * sizeof(LinkMappingRecord))});
+}
+
+bool ReadEmbeddingText(const std::string &prefix, VNEmbedding *embedding) {
+  *embedding = VNEmbedding();
+  FILE *infile = fopen((prefix + ".status").c_str(), "r");
+  if (!infile) return false;
+  char line[256];
+  if (fgets(line, sizeof(line), infile)) {
+    embedding->status = std::string(line, strcspn(line, "\r\n"));
+  }
+  fclose(infile);
+  // Without a cost file, only the status of a failed embedding was written.
+  infile = fopen((prefix + ".cost").c_str(), "r");
+  if (!infile) return true;
+  bool is_success = fscanf(infile, "%lf", &embedding->cost) == 1;
+  fclose(infile);
+  const char *kNodeFormats[] = {"Virtual node %d --> physical node %d",
+                                "Shadow virtual node of %d --> physical node "
+                                "%d"};
+  const char *kNodeSuffixes[] = {".nmap", ".snmap"};
+  for (int is_shadow = 0; is_shadow < 2 && is_success; ++is_shadow) {
+    auto &node_map = is_shadow ? embedding->shadow_node_map
+                               : embedding->node_map;
+    infile = fopen((prefix + kNodeSuffixes[is_shadow]).c_str(), "r");
+    if (!infile) return false;
+    while (fgets(line, sizeof(line), infile)) {
+      int m, u;
+      if (sscanf(line, kNodeFormats[is_shadow], &m, &u) != 2 || m < 0) {
+        is_success = false;
+        break;
+      }
+      if (node_map.size() <= m) node_map.resize(m + 1, NIL);
+      node_map[m] = u;
+    }
+    fclose(infile);
+  }
+  const char *kLinkFormats[] = {
+      "Virtual edge (%d, %d) --> physical edge (%d, %d)",
+      "Shadow virtual edge of (%d, %d) --> physical edge (%d, %d)"};
+  const char *kLinkSuffixes[] = {".emap", ".semap"};
+  for (int is_shadow = 0; is_shadow < 2 && is_success; ++is_shadow) {
+    auto &edge_map = is_shadow ? embedding->shadow_edge_map
+                               : embedding->edge_map;
+    infile = fopen((prefix + kLinkSuffixes[is_shadow]).c_str(), "r");
+    if (!infile) return false;
+    while (fgets(line, sizeof(line), infile)) {
+      int m, n, u, v;
+      if (sscanf(line, kLinkFormats[is_shadow], &m, &n, &u, &v) != 4) {
+        is_success = false;
+        break;
+      }
+      edge_map[std::make_pair(m, n)].push_back(std::make_pair(u, v));
+    }
+    fclose(infile);
+  }
+  return is_success;
+}
+
+bool WriteEmbeddingText(const VNEmbedding &embedding,
+                        const std::string &prefix) {
+  FILE *outfile = fopen((prefix + ".status").c_str(), "w");
+  if (!outfile) return false;
+  fprintf(outfile, "%s", embedding.status.c_str());
+  fclose(outfile);
+  if (embedding.node_map.empty()) return true;
+  outfile = fopen((prefix + ".cost").c_str(), "w");
+  if (!outfile) return false;
+  fprintf(outfile, "%lf\n", embedding.cost);
+  fclose(outfile);
+  const char *kNodeFormats[] = {"Virtual node %d --> physical node %d\n",
+                                "Shadow virtual node of %d --> physical node "
+                                "%d\n"};
+  const char *kNodeSuffixes[] = {".nmap", ".snmap"};
+  for (int is_shadow = 0; is_shadow < 2; ++is_shadow) {
+    auto &node_map = is_shadow ? embedding.shadow_node_map
+                               : embedding.node_map;
+    outfile = fopen((prefix + kNodeSuffixes[is_shadow]).c_str(), "w");
+    if (!outfile) return false;
+    for (int m = 0; m < node_map.size(); ++m) {
+      fprintf(outfile, kNodeFormats[is_shadow], m, node_map[m]);
+    }
+    fclose(outfile);
+  }
+  const char *kLinkFormats[] = {
+      "Virtual edge (%d, %d) --> physical edge (%d, %d)\n",
+      "Shadow virtual edge of (%d, %d) --> physical edge (%d, %d)\n"};
+  const char *kLinkSuffixes[] = {".emap", ".semap"};
+  for (int is_shadow = 0; is_shadow < 2; ++is_shadow) {
+    auto &edge_map = is_shadow ? embedding.shadow_edge_map
+                               : embedding.edge_map;
+    outfile = fopen((prefix + kLinkSuffixes[is_shadow]).c_str(), "w");
+    if (!outfile) return false;
+    for (auto &entry : edge_map) {
+      for (auto &link : entry.second) {
+        fprintf(outfile, kLinkFormats[is_shadow], entry.first.first,
+                entry.first.second, link.first, link.second);
+      }
+    }
+    fclose(outfile);
+  }
+  return true;
+}
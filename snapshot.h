@@ -0,0 +1,86 @@
+#ifndef SNAPSHOT_H_
+#define SNAPSHOT_H_
+
+#include "datastructure.h"
+
+#include <memory>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// Versioned binary snapshots of topologies and embeddings, which are read
+// without parsing. A file is a header followed by fixed-width records, all
+// in native byte order:
+//
+//   topology:  GraphSnapshotHeader, link_count LinkRecord
+//   embedding: EmbeddingSnapshotHeader, node_count NodeMappingRecord,
+//              link_count LinkMappingRecord
+//
+// Readers reject files with another magic number, version or size.
+const int kSnapshotVersion = 1;
+
+struct GraphSnapshotHeader {
+  char magic[4];  // "VNEG".
+  int32_t version;
+  int32_t node_count;
+  int32_t link_count;
+};
+
+// Links are stored in an order that adding them one by one to a Graph
+// reproduces the adjacency lists, and thus the edge ids, of the graph that
+// was written.
+struct LinkRecord {
+  int32_t u, v;
+  int32_t cost;
+  int32_t delay;
+  int64_t bandwidth;
+};
+
+struct EmbeddingSnapshotHeader {
+  char magic[4];  // "VNEE".
+  int32_t version;
+  char status[32];
+  double cost;
+  int32_t node_count;
+  int32_t link_count;
+};
+
+struct NodeMappingRecord {
+  int32_t node, shadow_node;
+};
+
+// One physical link (u, v) on the working, or if is_shadow is set, the shadow
+// path of virtual link (m, n). The links of a path are stored in path order.
+struct LinkMappingRecord {
+  int32_t m, n;
+  int32_t u, v;
+  int32_t is_shadow;
+};
+
+// Returns true if the size bytes at data start with a topology snapshot
+// header, regardless of its version.
+bool IsGraphSnapshot(const char *data, size_t size);
+
+// Builds the graph stored in the size bytes at data, e.g., a mapped file.
+// Returns NULL, after printing the reason, if they are not a valid snapshot.
+std::unique_ptr<Graph> ReadGraphSnapshot(const char *data, size_t size,
+                                         const char *filename);
+
+bool WriteGraphSnapshot(const Graph &graph, const char *filename);
+
+// Writes graph in the CSV format of the input files.
+bool WriteTopologyCSV(const Graph &graph, const char *filename);
+
+bool ReadEmbeddingSnapshot(const char *filename, VNEmbedding *embedding);
+bool WriteEmbeddingSnapshot(const VNEmbedding &embedding,
+                            const char *filename);
+
+// Reads and writes the text files of an embedding, i.e., prefix + ".status",
+// ".cost", ".nmap", ".snmap", ".emap" and ".semap", in the format written by
+// VNESolutionBuilder. Only the status is read and written for embeddings
+// without a node mapping.
+bool ReadEmbeddingText(const std::string &prefix, VNEmbedding *embedding);
+bool WriteEmbeddingText(const VNEmbedding &embedding,
+                        const std::string &prefix);
+
+#endif  // SNAPSHOT_H_
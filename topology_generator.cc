@@ -0,0 +1,244 @@
+#include "topology_generator.h"
+
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+
+namespace {
+
+void AddLink(int u, int v, const LinkParameters &links, std::mt19937 *random,
+             Graph *graph) {
+  std::uniform_int_distribution<long> bandwidth(links.min_bandwidth,
+                                                links.max_bandwidth);
+  std::uniform_int_distribution<int> cost(links.min_cost, links.max_cost);
+  std::uniform_int_distribution<int> delay(links.min_delay, links.max_delay);
+  long bw = bandwidth(*random);
+  int link_delay = delay(*random);
+  graph->add_edge(u, v, bw, link_delay, cost(*random));
+}
+
+// Links are drawn in two rounds: every node but the first links to an earlier
+// node, which keeps the network connected, then random pairs are linked until
+// the average degree is reached. Both rounds keep a candidate pair with the
+// Waxman probability; a node that rejects many candidates in the first round
+// links to the closest one instead.
+std::unique_ptr<Graph> GenerateWaxman(const TopologyParameters &parameters,
+                                      std::mt19937 *random) {
+  const int kMaxTreeCandidates = 1000;
+  int nodes = parameters.nodes;
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<double> x(nodes), y(nodes);
+  for (int u = 0; u < nodes; ++u) {
+    x[u] = unit(*random);
+    y[u] = unit(*random);
+  }
+  double scale = parameters.alpha * sqrt(2.0);
+  auto distance = [&x, &y](int u, int v) {
+    return hypot(x[u] - x[v], y[u] - y[v]);
+  };
+  auto is_kept = [&](int u, int v) {
+    return unit(*random) < parameters.beta * exp(-distance(u, v) / scale);
+  };
+  std::unique_ptr<Graph> graph(new Graph());
+  for (int u = 1; u < nodes; ++u) {
+    std::uniform_int_distribution<int> earlier_node(0, u - 1);
+    int closest = NIL;
+    for (int i = 0; i < kMaxTreeCandidates; ++i) {
+      int v = earlier_node(*random);
+      if (closest == NIL || distance(u, v) < distance(u, closest)) {
+        closest = v;
+      }
+      if (is_kept(u, v)) {
+        closest = v;
+        break;
+      }
+    }
+    AddLink(u, closest, parameters.links, random, graph.get());
+  }
+  long links = std::min(static_cast<long>(nodes) * parameters.degree / 2,
+                        static_cast<long>(nodes) * (nodes - 1) / 2);
+  std::uniform_int_distribution<int> node(0, nodes - 1);
+  while (graph->edge_count() < links) {
+    int u = node(*random), v = node(*random);
+    if (u == v || graph->edge_index(u, v) != NIL || !is_kept(u, v)) continue;
+    AddLink(u, v, parameters.links, random, graph.get());
+  }
+  return graph;
+}
+
+// Starts from a clique of one more node than every new node links to. Every
+// link end point is kept in a list, so a node is drawn from it in proportion
+// to its degree.
+std::unique_ptr<Graph> GenerateBarabasiAlbert(
+    const TopologyParameters &parameters, std::mt19937 *random) {
+  int nodes = parameters.nodes;
+  int links_per_node = std::min(std::max(1, parameters.degree / 2), nodes - 1);
+  std::unique_ptr<Graph> graph(new Graph());
+  std::vector<int> end_points;
+  for (int u = 0; u <= links_per_node; ++u) {
+    for (int v = 0; v < u; ++v) {
+      AddLink(u, v, parameters.links, random, graph.get());
+      end_points.push_back(u);
+      end_points.push_back(v);
+    }
+  }
+  std::vector<int> targets;
+  for (int u = links_per_node + 1; u < nodes; ++u) {
+    std::uniform_int_distribution<int> end_point(0, end_points.size() - 1);
+    targets.clear();
+    while (targets.size() < links_per_node) {
+      int v = end_points[end_point(*random)];
+      if (std::find(targets.begin(), targets.end(), v) == targets.end()) {
+        targets.push_back(v);
+      }
+    }
+    for (int v : targets) {
+      AddLink(u, v, parameters.links, random, graph.get());
+      end_points.push_back(u);
+      end_points.push_back(v);
+    }
+  }
+  return graph;
+}
+
+std::unique_ptr<Graph> GenerateGrid(const TopologyParameters &parameters,
+                                    std::mt19937 *random) {
+  int nodes = parameters.nodes;
+  int columns = ceil(sqrt(static_cast<double>(nodes)));
+  std::unique_ptr<Graph> graph(new Graph());
+  for (int u = 0; u < nodes; ++u) {
+    if ((u + 1) % columns != 0 && u + 1 < nodes) {
+      AddLink(u, u + 1, parameters.links, random, graph.get());
+    }
+    if (u + columns < nodes) {
+      AddLink(u, u + columns, parameters.links, random, graph.get());
+    }
+  }
+  return graph;
+}
+
+// Nodes are numbered core switches first, then pod by pod the aggregation
+// switches, the edge switches and the hosts below each edge switch.
+std::unique_ptr<Graph> GenerateFatTree(const TopologyParameters &parameters,
+                                       std::mt19937 *random) {
+  int k = 2;
+  while (5 * k * k / 4 + k * k * k / 4 < parameters.nodes) k += 2;
+  int half = k / 2;
+  int pod_size = half + half + half * half;
+  int first_pod = half * half;
+  std::unique_ptr<Graph> graph(new Graph());
+  for (int pod = 0; pod < k; ++pod) {
+    int aggregation = first_pod + pod * pod_size;
+    int edge = aggregation + half;
+    int host = edge + half;
+    for (int i = 0; i < half; ++i) {
+      for (int j = 0; j < half; ++j) {
+        AddLink(i * half + j, aggregation + i, parameters.links, random,
+                graph.get());
+        AddLink(aggregation + i, edge + j, parameters.links, random,
+                graph.get());
+        AddLink(edge + i, host + i * half + j, parameters.links, random,
+                graph.get());
+      }
+    }
+  }
+  return graph;
+}
+
+}  // namespace
+
+bool ParseTopologyModel(const std::string &name, TopologyModel *model) {
+  if (name == "waxman") {
+    *model = kWaxmanTopology;
+  } else if (name == "barabasi_albert") {
+    *model = kBarabasiAlbertTopology;
+  } else if (name == "grid") {
+    *model = kGridTopology;
+  } else if (name == "fat_tree") {
+    *model = kFatTreeTopology;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+std::unique_ptr<Graph> GenerateTopology(const TopologyParameters &parameters,
+                                        std::mt19937 *random) {
+  if (parameters.nodes < 2) return nullptr;
+  switch (parameters.model) {
+    case kWaxmanTopology:
+      return GenerateWaxman(parameters, random);
+    case kBarabasiAlbertTopology:
+      return GenerateBarabasiAlbert(parameters, random);
+    case kGridTopology:
+      return GenerateGrid(parameters, random);
+    case kFatTreeTopology:
+      return GenerateFatTree(parameters, random);
+  }
+  return nullptr;
+}
+
+std::unique_ptr<Graph> GenerateVirtualNetwork(int nodes, double density,
+                                              const LinkParameters &links,
+                                              std::mt19937 *random) {
+  if (nodes < 2) return nullptr;
+  std::unique_ptr<Graph> graph(new Graph());
+  std::uniform_real_distribution<double> unit(0.0, 1.0);
+  std::vector<int> parent(nodes, NIL);
+  for (int u = 1; u < nodes; ++u) {
+    std::uniform_int_distribution<int> earlier_node(0, u - 1);
+    parent[u] = earlier_node(*random);
+    AddLink(u, parent[u], links, random, graph.get());
+  }
+  for (int u = 1; u < nodes; ++u) {
+    for (int v = 0; v < u; ++v) {
+      if (v != parent[u] && unit(*random) < density) {
+        AddLink(u, v, links, random, graph.get());
+      }
+    }
+  }
+  return graph;
+}
+
+std::vector<std::vector<int> > GenerateLocationConstraints(
+    const Graph &physical_topology, const Graph &virt_topology, int locations,
+    int hops, std::mt19937 *random) {
+  auto &adj_list = *physical_topology.adj_list();
+  std::uniform_int_distribution<int> physical_node(
+      0, physical_topology.node_count() - 1);
+  std::vector<int> level(physical_topology.node_count(), NIL);
+  std::vector<std::vector<int> > location_constraints;
+  for (int m = 0; m < virt_topology.node_count(); ++m) {
+    int center = physical_node(*random);
+    std::vector<int> reached(1, center);
+    level[center] = 0;
+    for (int i = 0; i < reached.size(); ++i) {
+      int u = reached[i];
+      if (level[u] == hops) continue;
+      for (auto &end_point : adj_list[u]) {
+        if (level[end_point.node_id] != NIL) continue;
+        level[end_point.node_id] = level[u] + 1;
+        reached.push_back(end_point.node_id);
+      }
+    }
+    for (int u : reached) level[u] = NIL;
+    std::shuffle(reached.begin() + 1, reached.end(), *random);
+    if (reached.size() > locations) reached.resize(std::max(1, locations));
+    std::sort(reached.begin(), reached.end());
+    location_constraints.push_back(reached);
+  }
+  return location_constraints;
+}
+
+bool WriteLocationConstraints(
+    const std::vector<std::vector<int> > &location_constraints,
+    const char *filename) {
+  FILE *outfile = fopen(filename, "w");
+  if (!outfile) return false;
+  for (int m = 0; m < location_constraints.size(); ++m) {
+    fprintf(outfile, "%d", m);
+    for (int u : location_constraints[m]) fprintf(outfile, ",%d", u);
+    fprintf(outfile, "\n");
+  }
+  return fclose(outfile) == 0;
+}
@@ -0,0 +1,70 @@
+#ifndef TOPOLOGY_GENERATOR_H_
+#define TOPOLOGY_GENERATOR_H_
+
+#include "datastructure.h"
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic physical networks:
+//   kWaxmanTopology: nodes placed uniformly in the unit square; a link between
+//     nodes at distance d is kept with probability
+//     beta * exp(-d / (alpha * sqrt(2))).
+//   kBarabasiAlbertTopology: preferential attachment, every new node links to
+//     existing nodes chosen in proportion to their degree.
+//   kGridTopology: a two dimensional grid, filled row by row.
+//   kFatTreeTopology: a k-ary fat tree of core, aggregation and edge switches
+//     and hosts, for the smallest even k with at least the requested nodes.
+enum TopologyModel {
+  kWaxmanTopology,
+  kBarabasiAlbertTopology,
+  kGridTopology,
+  kFatTreeTopology
+};
+
+// Parses "waxman", "barabasi_albert", "grid" or "fat_tree". Returns false for
+// any other name.
+bool ParseTopologyModel(const std::string &name, TopologyModel *model);
+
+// Ranges the attributes of every generated link are drawn from uniformly.
+struct LinkParameters {
+  long min_bandwidth, max_bandwidth;
+  int min_cost, max_cost;
+  int min_delay, max_delay;
+};
+
+struct TopologyParameters {
+  TopologyModel model;
+  int nodes;
+  // Average node degree of Waxman and Barabasi-Albert topologies; every new
+  // node of the latter adds degree / 2 links.
+  int degree;
+  double alpha, beta;
+  LinkParameters links;
+};
+
+// Returns a connected physical network, or NULL if the parameters cannot
+// give one, e.g., fewer than two nodes.
+std::unique_ptr<Graph> GenerateTopology(const TopologyParameters &parameters,
+                                        std::mt19937 *random);
+
+// Returns a connected virtual network of nodes nodes: a random spanning tree
+// plus every other pair of nodes linked with probability density.
+std::unique_ptr<Graph> GenerateVirtualNetwork(int nodes, double density,
+                                              const LinkParameters &links,
+                                              std::mt19937 *random);
+
+// Returns, for every node of virt_topology, up to locations physical nodes
+// at most hops hops away from a random physical node, which is one of them.
+std::vector<std::vector<int> > GenerateLocationConstraints(
+    const Graph &physical_topology, const Graph &virt_topology, int locations,
+    int hops, std::mt19937 *random);
+
+// Writes location constraints in the format of the input files.
+bool WriteLocationConstraints(
+    const std::vector<std::vector<int> > &location_constraints,
+    const char *filename);
+
+#endif  // TOPOLOGY_GENERATOR_H_
@@ -1,8 +1,16 @@
+#include "util.h"
+
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
 #include <map>
+#include <mutex>
 #include <stdarg.h>
 #include <stdio.h>
 #include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <typeinfo>
 
 void PrintDebugMessage(const char *location, const char *fmt_string, ...) {
   va_list args;
@@ -14,6 +22,61 @@ void PrintDebugMessage(const char *location, const char *fmt_string, ...) {
   va_end(args);
 }
 
+long GetPeakMemoryUsageKB() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+void RunInOrder(int count, int threads, int window,
+                const std::function<void(int)> &task,
+                const std::function<void(int)> &merge) {
+  if (threads <= 1 || count <= 1) {
+    for (int i = 0; i < count; ++i) {
+      task(i);
+      merge(i);
+    }
+    return;
+  }
+  std::mutex mutex;
+  std::condition_variable finished, merged;
+  std::vector<bool> is_finished(count, false);
+  std::atomic<int> next_task(0);
+  int merged_count = 0;
+  window = std::max(1, window);
+  auto run_tasks = [&]() {
+    for (int i = next_task++; i < count; i = next_task++) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        merged.wait(lock, [&merged_count, i, window]() {
+          return i - merged_count < window;
+        });
+      }
+      task(i);
+      std::lock_guard<std::mutex> lock(mutex);
+      is_finished[i] = true;
+      finished.notify_one();
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 0; i < std::min(threads, count); ++i) {
+    workers.push_back(std::thread(run_tasks));
+  }
+  for (int i = 0; i < count; ++i) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [&is_finished, i]() { return is_finished[i]; });
+    }
+    merge(i);
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      merged_count = i + 1;
+    }
+    merged.notify_all();
+  }
+  for (auto &worker : workers) worker.join();
+}
+
 template <class T>
 double GetMean(const std::vector<T> &data) {
   T sum = T(0);
@@ -1,6 +1,7 @@
 #ifndef UTIL_H_
 #define UTIL_H_
 
+#include <functional>
 #include <vector>
 #include <utility>
 
@@ -21,6 +22,18 @@
 // file before the message.
 void PrintDebugMessage(const char *location, const char *fmt_string, ...);
 
+// Returns the peak resident set size of the calling process in KB.
+long GetPeakMemoryUsageKB();
+
+// Runs task(0), ..., task(count - 1) on up to threads threads and calls
+// merge(i) on the calling thread in the order of i, as soon as task(i) has
+// finished. A task does not start while window or more tasks before it are
+// still waiting to be merged, so at most window results are held at a time.
+// With one thread, every task is merged right after it has run.
+void RunInOrder(int count, int threads, int window,
+                const std::function<void(int)> &task,
+                const std::function<void(int)> &merge);
+
 // Returns the mean of the vector of data.
 template <class T>
 double GetMean(const std::vector<T> &data);
@@ -0,0 +1,175 @@
+#include "vne_batch.h"
+#include "mip_backend.h"
+
+#include <algorithm>
+#include <dirent.h>
+#include <fcntl.h>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace {
+// Returns the sorted names of the subdirectories of directory.
+std::vector<std::string> ListSubdirectories(const std::string &directory) {
+  std::vector<std::string> subdirectories;
+  DIR *dir = opendir(directory.c_str());
+  if (!dir) return subdirectories;
+  while (dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") continue;
+    struct stat info;
+    if (stat((directory + "/" + name).c_str(), &info) == 0 &&
+        S_ISDIR(info.st_mode)) {
+      subdirectories.push_back(name);
+    }
+  }
+  closedir(dir);
+  std::sort(subdirectories.begin(), subdirectories.end());
+  return subdirectories;
+}
+
+TestCase MakeTestCase(const std::string &directory,
+                      const std::string &pn_topology_file) {
+  TestCase test_case;
+  test_case.directory = directory;
+  test_case.pn_topology_file = pn_topology_file;
+  test_case.vn_topology_file = directory + "/vn.txt";
+  test_case.location_constraint_file = directory + "/vnloc.txt";
+  return test_case;
+}
+
+// A worker process and the read end of the pipe it reports its result on.
+struct Worker {
+  int test_case;
+  int result_fd;
+};
+
+// Runs solve_instance for test_case in the calling (child) process and
+// writes the result to result_fd.
+void RunWorker(const TestCase &test_case, int result_fd,
+               const std::function<void(const TestCase &, InstanceResult *)> &
+                   solve_instance) {
+  int stdout_fd = open((test_case.directory + "/stdout").c_str(),
+                       O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int stderr_fd = open((test_case.directory + "/stderr").c_str(),
+                       O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (stdout_fd >= 0) dup2(stdout_fd, STDOUT_FILENO);
+  if (stderr_fd >= 0) dup2(stderr_fd, STDERR_FILENO);
+  InstanceResult result;
+  memset(&result, 0, sizeof(result));
+  solve_instance(test_case, &result);
+  fflush(stdout);
+  fflush(stderr);
+  if (write(result_fd, &result, sizeof(result)) != sizeof(result)) _exit(1);
+  _exit(0);
+}
+}  // namespace
+
+std::vector<TestCase> FindTestCases(const std::string &root) {
+  std::vector<TestCase> test_cases;
+  for (auto &test : ListSubdirectories(root)) {
+    std::string path = root + "/" + test;
+    std::string pn_topology_file = path + "/sn2.txt";
+    if (access(pn_topology_file.c_str(), R_OK)) {
+      pn_topology_file = path + "/sn.txt";
+    }
+    auto vnr_roots = ListSubdirectories(path);
+    if (vnr_roots.empty()) {
+      test_cases.push_back(MakeTestCase(path, pn_topology_file));
+      continue;
+    }
+    for (auto &vnr_root : vnr_roots) {
+      std::string vnr_root_path = path + "/" + vnr_root;
+      for (auto &vnr_type : ListSubdirectories(vnr_root_path)) {
+        std::string vnr_type_path = vnr_root_path + "/" + vnr_type;
+        for (auto &vnr_case : ListSubdirectories(vnr_type_path)) {
+          test_cases.push_back(MakeTestCase(vnr_type_path + "/" + vnr_case,
+                                            pn_topology_file));
+        }
+      }
+    }
+  }
+  return test_cases;
+}
+
+bool RunBatch(const std::vector<TestCase> &test_cases, int jobs,
+              const std::string &results_file,
+              const std::function<void(const TestCase &, InstanceResult *)> &
+                  solve_instance) {
+  FILE *outfile = fopen(results_file.c_str(), "w");
+  if (!outfile) return false;
+  std::vector<InstanceResult> results(test_cases.size());
+  std::vector<long> peak_memory_kb(test_cases.size(), 0);
+  std::map<pid_t, Worker> workers;
+  // Output buffered before fork() would otherwise be flushed by every child.
+  fflush(stdout);
+  fflush(outfile);
+  int next = 0;
+  while (next < test_cases.size() || !workers.empty()) {
+    if (next < test_cases.size() && workers.size() < jobs) {
+      int fds[2];
+      if (pipe(fds) == 0) {
+        pid_t pid = fork();
+        if (pid == 0) {
+          close(fds[0]);
+          RunWorker(test_cases[next], fds[1], solve_instance);
+        }
+        close(fds[1]);
+        if (pid > 0) {
+          Worker worker = {next++, fds[0]};
+          workers[pid] = worker;
+          continue;
+        }
+        close(fds[0]);
+      }
+      // Without a new worker, wait for a running one to finish first.
+      if (workers.empty()) {
+        perror("Cannot start worker");
+        fclose(outfile);
+        return false;
+      }
+    }
+    int status;
+    struct rusage usage;
+    pid_t pid = wait4(-1, &status, 0, &usage);
+    if (pid < 0 || workers.find(pid) == workers.end()) continue;
+    Worker worker = workers[pid];
+    workers.erase(pid);
+    InstanceResult &result = results[worker.test_case];
+    memset(&result, 0, sizeof(result));
+    result.root_bound = -MIP_INFINITY;
+    if (read(worker.result_fd, &result, sizeof(result)) != sizeof(result)) {
+      snprintf(result.status, sizeof(result.status), "%s",
+               WIFSIGNALED(status) ? strsignal(WTERMSIG(status)) : "Failed");
+    }
+    result.status[sizeof(result.status) - 1] = '\0';
+    close(worker.result_fd);
+    peak_memory_kb[worker.test_case] = usage.ru_maxrss;
+    printf("Completed %s: %s\n", test_cases[worker.test_case].directory.c_str(),
+           result.status);
+    fflush(stdout);
+  }
+  fprintf(outfile, "testcase,status,cost,variables,constraints,"
+                   "lazy_constraints,root_bound,nodes,build_time,"
+                   "export_time,solve_time,peak_rss_kb\n");
+  for (int i = 0; i < test_cases.size(); ++i) {
+    // Runs without a root bound, e.g., heuristic runs or runs that did not
+    // solve, leave the field empty.
+    char root_bound[32] = "";
+    if (results[i].root_bound > -MIP_INFINITY) {
+      snprintf(root_bound, sizeof(root_bound), "%lf", results[i].root_bound);
+    }
+    fprintf(outfile, "%s,%s,%lf,%d,%d,%d,%s,%ld,%.3lf,%.3lf,%.3lf,%ld\n",
+            test_cases[i].directory.c_str(), results[i].status, results[i].cost,
+            results[i].variables, results[i].constraints,
+            results[i].lazy_constraints, root_bound, results[i].nodes,
+            results[i].build_time, results[i].export_time,
+            results[i].solve_time, peak_memory_kb[i]);
+  }
+  fclose(outfile);
+  return true;
+}
@@ -0,0 +1,49 @@
+#ifndef VNE_BATCH_H_
+#define VNE_BATCH_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+// Input files of one problem instance. directory receives the output files of
+// the instance.
+struct TestCase {
+  std::string directory;
+  std::string pn_topology_file;
+  std::string vn_topology_file;
+  std::string location_constraint_file;
+};
+
+// Outcome of solving one instance. It is passed from a worker process to the
+// batch runner as raw bytes, hence the fixed size status.
+struct InstanceResult {
+  char status[32];
+  double cost;
+  // Size of the ILP model and the bound at the root of its search.
+  int variables;
+  int constraints;
+  int lazy_constraints;
+  double root_bound;
+  // Number of branch-and-bound nodes.
+  long nodes;
+  double build_time;
+  double export_time;
+  double solve_time;
+};
+
+// Returns the test cases below root in the layout of TestSet-0 and TestSet-1
+// (see README.md), sorted by directory.
+std::vector<TestCase> FindTestCases(const std::string &root);
+
+// Solves every test case in a separate worker process, running up to jobs of
+// them at a time. The standard output and error of a worker are written to
+// the files stdout and stderr in the directory of its test case. Writes one
+// line per test case with the result and the peak resident set size of its
+// worker to results_file in CSV format. Returns false if results_file cannot
+// be written.
+bool RunBatch(const std::vector<TestCase> &test_cases, int jobs,
+              const std::string &results_file,
+              const std::function<void(const TestCase &, InstanceResult *)> &
+                  solve_instance);
+
+#endif  // VNE_BATCH_H_
@@ -0,0 +1,148 @@
+#include "vne_embedder.h"
+#include "mip_backend.h"
+#include "vne_heuristic_solver.h"
+#include "vne_path_solver.h"
+#include "vne_protection_solver.h"
+#include "vne_solution_builder.h"
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+
+bool ParseEmbeddingOptions(std::map<std::string, std::string> *arg_map,
+                           EmbeddingOptions *options) {
+  EmbeddingOptions defaults = {"ilp", kDefaultMIPBackend, "none",
+                               kIndicatorFormulation};
+  *options = defaults;
+  for (auto it = arg_map->begin(); it != arg_map->end();) {
+    const std::string &option = it->first, &value = it->second;
+    bool is_embedding_option = true;
+    if (option == "--solver") {
+      options->solver = value;
+    } else if (option == "--backend") {
+      options->backend = value;
+    } else if (option == "--mip_start") {
+      options->mip_start = value;
+    } else if (option == "--formulation") {
+      if (!ParseFormulation(value, &options->formulation)) {
+        printf("Unknown formulation: %s\n", value.c_str());
+        return false;
+      }
+    } else if (option == "--lazy_disjointness") {
+      options->lazy_disjointness = value == "true";
+    } else if (option == "--symmetry_breaking") {
+      options->symmetry_breaking = value == "true";
+    } else if (option == "--export_model") {
+      options->export_model = value;
+    } else if (option == "--reuse_model") {
+      options->reuse_model = value == "true";
+    } else if (option == "--build_threads") {
+      options->build_threads = atoi(value.c_str());
+    } else {
+      is_embedding_option =
+          ParseMIPParameter(option, value, &options->mip_parameters);
+    }
+    if (is_embedding_option) {
+      it = arg_map->erase(it);
+    } else {
+      ++it;
+    }
+  }
+  if (options->solver != "ilp" && options->solver != "heuristic" &&
+      options->solver != "path") {
+    printf("Unknown solver: %s\n", options->solver.c_str());
+    return false;
+  }
+  if (options->mip_start != "none" && options->mip_start != "heuristic") {
+    printf("Unknown MIP start: %s\n", options->mip_start.c_str());
+    return false;
+  }
+  if (options->solver != "heuristic" && !CreateMIPBackend(options->backend)) {
+    printf("Unknown or unavailable MIP backend: %s\n",
+           options->backend.c_str());
+    return false;
+  }
+  if (options->lazy_disjointness &&
+      options->formulation == kIndicatorFormulation) {
+    printf("--lazy_disjointness requires --formulation=aggregated or "
+           "disaggregated\n");
+    return false;
+  }
+  if (options->symmetry_breaking &&
+      options->formulation == kIndicatorFormulation &&
+      options->mip_start != "heuristic") {
+    printf("Warning: --symmetry_breaking can slow down the indicator "
+           "formulation without --mip_start=heuristic\n");
+  }
+  return true;
+}
+
+VirtualNetworkEmbedder::VirtualNetworkEmbedder(
+    const EmbeddingOptions &options, Graph *physical_topology)
+    : options_(options),
+      physical_topology_(physical_topology),
+      model_count_(0),
+      build_time_(0.0) {}
+
+bool VirtualNetworkEmbedder::Embed(
+    Graph *virt_topology, std::vector<std::vector<int> > *location_constraint,
+    VNEmbedding *embedding) {
+  if (options_.solver == "heuristic" || options_.mip_start == "heuristic") {
+    VNEProtectionHeuristicSolver heuristic_solver(
+        physical_topology_, virt_topology, location_constraint);
+    bool is_success = heuristic_solver.Solve();
+    *embedding = heuristic_solver.embedding();
+    if (options_.solver == "heuristic") return is_success;
+  }
+  auto build_start_time = std::chrono::steady_clock::now();
+  if (options_.solver == "path") {
+    vne_solver_.reset();
+    backend_ = CreateMIPBackend(options_.backend);
+    backend_->SetParameters(options_.mip_parameters);
+    VNEPathSolver path_solver(backend_.get(), physical_topology_,
+                              virt_topology, location_constraint);
+    path_solver.BuildModel();
+    std::chrono::duration<double> build_time =
+        std::chrono::steady_clock::now() - build_start_time;
+    build_time_ += build_time.count();
+    ++model_count_;
+    if (embedding->status == "Successful") path_solver.SetMIPStart(*embedding);
+    bool is_success = path_solver.GeneratePaths() && path_solver.Solve();
+    *embedding = path_solver.embedding();
+    return is_success;
+  }
+  if (options_.reuse_model) {
+    if (!vne_solver_) {
+      backend_ = CreateMIPBackend(options_.backend);
+      backend_->SetParameters(options_.mip_parameters);
+      vne_solver_.reset(new VNEProtectionSolver(
+          backend_.get(), physical_topology_, options_.formulation));
+    }
+    vne_solver_->SetVirtualNetwork(virt_topology, virt_topology,
+                                   location_constraint);
+  } else {
+    vne_solver_.reset();
+    backend_ = CreateMIPBackend(options_.backend);
+    backend_->SetParameters(options_.mip_parameters);
+    vne_solver_.reset(new VNEProtectionSolver(
+        backend_.get(), physical_topology_, virt_topology, virt_topology,
+        location_constraint, options_.formulation));
+  }
+  vne_solver_->set_lazy_disjointness(options_.lazy_disjointness);
+  vne_solver_->set_symmetry_breaking(options_.symmetry_breaking);
+  vne_solver_->BuildModel(options_.build_threads);
+  std::chrono::duration<double> build_time =
+      std::chrono::steady_clock::now() - build_start_time;
+  build_time_ += build_time.count();
+  ++model_count_;
+  if (embedding->status == "Successful") vne_solver_->SetMIPStart(*embedding);
+  if (!options_.export_model.empty() &&
+      !backend_->ExportModel(options_.export_model.c_str())) {
+    printf("Cannot export model to %s\n", options_.export_model.c_str());
+  }
+  bool is_success = vne_solver_->Solve();
+  VNESolutionBuilder solution_builder(vne_solver_.get(), physical_topology_,
+                                      virt_topology);
+  *embedding = solution_builder.embedding();
+  return is_success;
+}
@@ -0,0 +1,80 @@
+#ifndef VNE_EMBEDDER_H_
+#define VNE_EMBEDDER_H_
+
+#include "datastructure.h"
+#include "mip_backend.h"
+#include "vne_protection_solver.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// How virtual networks are embedded; mirrors the command line options of the
+// same names.
+struct EmbeddingOptions {
+  std::string solver;
+  std::string backend;
+  std::string mip_start;
+  Formulation formulation;
+  MIPParameters mip_parameters;
+  // Whether the disjointness constraints are lazy constraints, see
+  // VNEProtectionSolver::set_lazy_disjointness().
+  bool lazy_disjointness;
+  // Whether the ILP model gets symmetry breaking constraints, see
+  // VNEProtectionSolver::set_symmetry_breaking().
+  bool symmetry_breaking;
+  // File the model is exported to before it is solved, or empty.
+  std::string export_model;
+  // Whether VirtualNetworkEmbedder keeps the model of the physical network
+  // across virtual networks. The path solver always builds a new model.
+  bool reuse_model;
+  // Number of threads generating the constraints of the ILP model; one if
+  // not positive.
+  int build_threads;
+};
+
+// Sets options to the defaults and then to the values of the command line
+// options --solver, --backend, --mip_start, --formulation,
+// --lazy_disjointness, --symmetry_breaking, --export_model, --reuse_model,
+// --build_threads and the MIP parameters of ParseMIPParameter() in arg_map,
+// which are removed from it; the options of the calling program are left.
+// Prints a warning for combinations that are valid but likely slow. Returns
+// false, after printing why, if a value or the combination is invalid. A MIP
+// parameter with an invalid value is left in arg_map instead, like an unknown
+// option.
+bool ParseEmbeddingOptions(std::map<std::string, std::string> *arg_map,
+                           EmbeddingOptions *options);
+
+// Embeds virtual networks with 1 + 1 protection onto the residual bandwidth of
+// physical_topology, one after the other, using the solver selected by
+// options. If options.reuse_model is set, the part of the ILP model that only
+// depends on the physical network is built once and kept in one backend, and
+// every virtual network only replaces the rest of the model. Otherwise every
+// virtual network gets a new backend and model.
+class VirtualNetworkEmbedder {
+ public:
+  VirtualNetworkEmbedder(const EmbeddingOptions &options,
+                         Graph *physical_topology);
+
+  // Returns true if an embedding has been found; embedding is filled in
+  // either way, at least with the solution status. No bandwidth is reserved.
+  bool Embed(Graph *virt_topology,
+             std::vector<std::vector<int> > *location_constraint,
+             VNEmbedding *embedding);
+
+  // Number of ILP models built and the total time spent on building them,
+  // including the setup of the backends.
+  int model_count() const { return model_count_; }
+  double build_time() const { return build_time_; }
+
+ private:
+  EmbeddingOptions options_;
+  Graph *physical_topology_;
+  std::unique_ptr<MIPBackend> backend_;
+  std::unique_ptr<VNEProtectionSolver> vne_solver_;
+  int model_count_;
+  double build_time_;
+};
+
+#endif  // VNE_EMBEDDER_H_
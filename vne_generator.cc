@@ -0,0 +1,149 @@
+// Generates a synthetic physical network and a workload of virtual network
+// requests with their location constraints in the layout read by
+// vne_simulator (see topology_generator.h for the topology models).
+#include "io.h"
+#include "snapshot.h"
+#include "topology_generator.h"
+
+#include <chrono>
+#include <sys/stat.h>
+
+const std::string kUsage = "./vne_generator "
+                           "--model=<waxman|barabasi_albert|grid|fat_tree>\n\t"
+                           "--nodes=<n> [--degree=<d>] [--alpha=<a>] "
+                           "[--beta=<b>]\n\t"
+                           "[--min_bandwidth=<bw>] [--max_bandwidth=<bw>]\n\t"
+                           "[--requests=<r>] [--min_vn_nodes=<n>] "
+                           "[--max_vn_nodes=<n>]\n\t"
+                           "[--vn_density=<p>] [--min_vn_bandwidth=<bw>] "
+                           "[--max_vn_bandwidth=<bw>]\n\t"
+                           "[--locations=<l>] [--location_hops=<h>]\n\t"
+                           "[--arrival_rate=<rate>] [--lifetime=<time>]\n\t"
+                           "[--seed=<seed>] [--output_directory=<directory>]";
+
+int main(int argc, char *argv[]) {
+  using std::string;
+  auto arg_map = ParseArgs(argc, argv);
+  TopologyParameters parameters = {kWaxmanTopology, 0, 4, 0.4, 0.1,
+                                   {35000, 40000, 1, 5, 1, 5}};
+  LinkParameters vn_links = {8000, 10000, 0, 0, 0, 0};
+  string model = "";
+  string output_directory = ".";
+  int requests = 1, min_vn_nodes = 4, max_vn_nodes = 8;
+  int locations = 8, location_hops = 4;
+  double vn_density = 0.5, arrival_rate = 0.05, lifetime = 100.0;
+  unsigned int seed = 0x5414ab;
+  for (auto argument : *arg_map) {
+    const char *value = argument.second.c_str();
+    if (argument.first == "--model") {
+      model = argument.second;
+    } else if (argument.first == "--nodes") {
+      parameters.nodes = atoi(value);
+    } else if (argument.first == "--degree") {
+      parameters.degree = atoi(value);
+    } else if (argument.first == "--alpha") {
+      parameters.alpha = atof(value);
+    } else if (argument.first == "--beta") {
+      parameters.beta = atof(value);
+    } else if (argument.first == "--min_bandwidth") {
+      parameters.links.min_bandwidth = atol(value);
+    } else if (argument.first == "--max_bandwidth") {
+      parameters.links.max_bandwidth = atol(value);
+    } else if (argument.first == "--requests") {
+      requests = atoi(value);
+    } else if (argument.first == "--min_vn_nodes") {
+      min_vn_nodes = atoi(value);
+    } else if (argument.first == "--max_vn_nodes") {
+      max_vn_nodes = atoi(value);
+    } else if (argument.first == "--vn_density") {
+      vn_density = atof(value);
+    } else if (argument.first == "--min_vn_bandwidth") {
+      vn_links.min_bandwidth = atol(value);
+    } else if (argument.first == "--max_vn_bandwidth") {
+      vn_links.max_bandwidth = atol(value);
+    } else if (argument.first == "--locations") {
+      locations = atoi(value);
+    } else if (argument.first == "--location_hops") {
+      location_hops = atoi(value);
+    } else if (argument.first == "--arrival_rate") {
+      arrival_rate = atof(value);
+    } else if (argument.first == "--lifetime") {
+      lifetime = atof(value);
+    } else if (argument.first == "--seed") {
+      seed = strtoul(value, NULL, 0);
+    } else if (argument.first == "--output_directory") {
+      output_directory = argument.second;
+    } else {
+      printf("Unknown option %s\n%s\n", argument.first.c_str(),
+             kUsage.c_str());
+      return 1;
+    }
+  }
+  if (!ParseTopologyModel(model, &parameters.model) || parameters.nodes < 2 ||
+      requests < 0 || min_vn_nodes < 2 || max_vn_nodes < min_vn_nodes ||
+      locations < 1 || arrival_rate <= 0.0 || lifetime <= 0.0 ||
+      parameters.links.min_bandwidth > parameters.links.max_bandwidth ||
+      vn_links.min_bandwidth > vn_links.max_bandwidth) {
+    printf("%s\n", kUsage.c_str());
+    return 1;
+  }
+
+  std::mt19937 random(seed);
+  auto start_time = std::chrono::steady_clock::now();
+  auto physical_topology = GenerateTopology(parameters, &random);
+  std::chrono::duration<double> generation_time =
+      std::chrono::steady_clock::now() - start_time;
+  printf("Generated %d nodes, %d links in %.3lf s\n",
+         physical_topology->node_count(), physical_topology->edge_count(),
+         generation_time.count());
+  // Creates the output directory and its missing parents.
+  string vnr_directory = output_directory + "/vnr";
+  for (int i = 1; i <= vnr_directory.size(); ++i) {
+    if (i == vnr_directory.size() || vnr_directory[i] == '/') {
+      mkdir(vnr_directory.substr(0, i).c_str(), 0755);
+    }
+  }
+  string pn_topology_file = output_directory + "/sn.txt";
+  if (!WriteTopologyCSV(*physical_topology, pn_topology_file.c_str())) {
+    printf("Cannot write %s\n", pn_topology_file.c_str());
+    return 1;
+  }
+
+  // Requests arrive as a Poisson process and stay for an exponentially
+  // distributed time, in whole time units as in sim-generator.py.
+  string plan_file = output_directory + "/vnr-simulation";
+  FILE *plan = fopen(plan_file.c_str(), "w");
+  if (!plan) {
+    printf("Cannot write %s\n", plan_file.c_str());
+    return 1;
+  }
+  std::uniform_int_distribution<int> vn_nodes(min_vn_nodes, max_vn_nodes);
+  std::exponential_distribution<double> wait_time(arrival_rate);
+  std::exponential_distribution<double> duration(1.0 / lifetime);
+  int current_time = 0;
+  for (int i = 0; i < requests; ++i) {
+    auto virt_topology = GenerateVirtualNetwork(vn_nodes(random), vn_density,
+                                                vn_links, &random);
+    auto location_constraints = GenerateLocationConstraints(
+        *physical_topology, *virt_topology, locations, location_hops,
+        &random);
+    string vn_topology_file = vnr_directory + "/vn" + std::to_string(i);
+    if (!WriteTopologyCSV(*virt_topology, vn_topology_file.c_str()) ||
+        !WriteLocationConstraints(location_constraints,
+                                  (vn_topology_file + "loc").c_str())) {
+      printf("Cannot write %s\n", vn_topology_file.c_str());
+      fclose(plan);
+      return 1;
+    }
+    int ends_at = current_time + static_cast<int>(duration(random)) + 1;
+    fprintf(plan, "%d,%d,vn%d\n", current_time, ends_at, i);
+    current_time += static_cast<int>(wait_time(random)) + 1;
+  }
+  if (fclose(plan) != 0) {
+    printf("Cannot write %s\n", plan_file.c_str());
+    return 1;
+  }
+  printf("Wrote %s and %d virtual network requests to %s\n",
+         pn_topology_file.c_str(), requests, vnr_directory.c_str());
+  return 0;
+}
@@ -0,0 +1,310 @@
+#include "vne_heuristic_solver.h"
+#include "util.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+
+namespace {
+// Number of candidate paths considered for a working virtual link.
+const int kNumCandidatePaths = 4;
+const long kUnreachable = std::numeric_limits<long>::max();
+
+struct VirtualLink {
+  int m, n;
+  long bandwidth;
+};
+}  // namespace
+
+VNEProtectionHeuristicSolver::VNEProtectionHeuristicSolver(
+    Graph *physical_topology, Graph *virt_topology,
+    std::vector<std::vector<int> > *location_constraint)
+    : physical_topology_(physical_topology),
+      virt_topology_(virt_topology),
+      location_constraint_(location_constraint),
+      pn_(*physical_topology) {
+  distance_.resize(physical_topology_->node_count());
+}
+
+bool VNEProtectionHeuristicSolver::Solve() {
+  embedding_ = VNEmbedding();
+  embedding_.status = "Unknown";
+  for (int attempt = 0; attempt <= virt_topology_->node_count(); ++attempt) {
+    int swapped_node = attempt == 0 ? NIL : attempt - 1;
+    std::vector<int> node_map, shadow_node_map;
+    if (!MapNodes(swapped_node, &node_map, &shadow_node_map)) continue;
+    VNEmbedding embedding;
+    if (!MapLinks(node_map, shadow_node_map, &embedding)) continue;
+    DEBUG("Attempt %d: cost = %lf\n", attempt, embedding.cost);
+    if (embedding_.status != "Successful" || embedding.cost < embedding_.cost) {
+      embedding_ = embedding;
+      embedding_.status = "Successful";
+    }
+  }
+  return embedding_.status == "Successful";
+}
+
+bool VNEProtectionHeuristicSolver::MapNodes(int swapped_node,
+                                            std::vector<int> *node_map,
+                                            std::vector<int> *shadow_node_map) {
+  int vn_node_count = virt_topology_->node_count();
+  // Map the most constrained virtual nodes first.
+  std::vector<int> order(vn_node_count);
+  for (int m = 0; m < vn_node_count; ++m) order[m] = m;
+  std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+    int a_choices = location_constraint_->at(a).size();
+    int b_choices = location_constraint_->at(b).size();
+    if (a_choices != b_choices) return a_choices < b_choices;
+    return virt_topology_->adj_list()->at(a).size() >
+           virt_topology_->adj_list()->at(b).size();
+  });
+
+  std::vector<bool> used(physical_topology_->node_count(), false);
+  node_map->assign(vn_node_count, NIL);
+  shadow_node_map->assign(vn_node_count, NIL);
+  // Working nodes first, then shadow nodes. A candidate's score is the
+  // bandwidth weighted cost of reaching the hosts of the already mapped
+  // neighbors.
+  for (int phase = 0; phase < 2; ++phase) {
+    std::vector<int> &host = phase == 0 ? *node_map : *shadow_node_map;
+    for (int m : order) {
+      auto &candidates = location_constraint_->at(m);
+      int unused_candidates = 0;
+      for (int u : candidates) {
+        if (!used[u]) ++unused_candidates;
+      }
+      // The working host must leave a candidate for the shadow host.
+      if (unused_candidates < 2 - phase) return false;
+      int best_host = NIL;
+      long best_score = kUnreachable;
+      for (int u : candidates) {
+        if (used[u]) continue;
+        long score = 0;
+        for (auto &end_point : virt_topology_->adj_list()->at(m)) {
+          int v = host[end_point.node_id];
+          if (v == NIL) continue;
+          long distance = Distance(u, v);
+          if (distance == kUnreachable) {
+            score = kUnreachable;
+            break;
+          }
+          score += end_point.bandwidth * distance;
+        }
+        if (best_host == NIL || score < best_score) {
+          best_host = u;
+          best_score = score;
+        }
+      }
+      host[m] = best_host;
+      used[best_host] = true;
+    }
+  }
+  if (swapped_node != NIL) {
+    std::swap(node_map->at(swapped_node), shadow_node_map->at(swapped_node));
+  }
+  return true;
+}
+
+bool VNEProtectionHeuristicSolver::MapLinks(
+    const std::vector<int> &node_map, const std::vector<int> &shadow_node_map,
+    VNEmbedding *embedding) {
+  int pn_node_count = physical_topology_->node_count();
+  std::vector<long> residual(pn_.edge_count());
+  for (int uv = 0; uv < pn_.edge_count(); ++uv) {
+    residual[uv] = pn_.residual_bandwidth(uv);
+  }
+  // Route links with the largest bandwidth demand first.
+  std::vector<VirtualLink> links;
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    for (auto &end_point : virt_topology_->adj_list()->at(m)) {
+      if (m < end_point.node_id) continue;
+      VirtualLink link = {m, end_point.node_id, end_point.bandwidth};
+      links.push_back(link);
+    }
+  }
+  std::stable_sort(links.begin(), links.end(),
+                   [](const VirtualLink &a, const VirtualLink &b) {
+    return a.bandwidth > b.bandwidth;
+  });
+
+  // Working paths must not pass through shadow hosts; shadow paths must not
+  // touch any node used by the working network.
+  std::vector<bool> shadow_host(pn_node_count, false);
+  std::vector<bool> working_node(pn_node_count, false);
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    shadow_host[shadow_node_map[m]] = true;
+    working_node[node_map[m]] = true;
+  }
+  std::vector<bool> no_removed_edge(pn_.edge_count(), false);
+  auto reserve = [&](const Path &path, long bandwidth) {
+    for (int uv : path) {
+      residual[uv] -= bandwidth;
+      residual[pn_.reverse(uv)] -= bandwidth;
+    }
+  };
+  auto to_links = [this](const Path &path) {
+    std::vector<std::pair<int, int> > physical_links;
+    for (int uv : path) {
+      physical_links.push_back(std::make_pair(pn_.tail(uv), pn_.head(uv)));
+    }
+    return physical_links;
+  };
+
+  embedding->node_map = node_map;
+  embedding->shadow_node_map = shadow_node_map;
+  embedding->cost = 0.0;
+  for (auto &link : links) {
+    std::vector<Path> candidates;
+    KShortestPaths(node_map[link.m], node_map[link.n], link.bandwidth,
+                   residual, shadow_host, kNumCandidatePaths, &candidates);
+    if (candidates.empty()) return false;
+    // Prefer the cheapest path that still leaves room for the shadow link.
+    int chosen = 0;
+    for (int i = 0; i < candidates.size(); ++i) {
+      std::vector<bool> blocked = working_node;
+      for (int uv : candidates[i]) blocked[pn_.head(uv)] = true;
+      Path shadow_path;
+      if (ShortestPath(shadow_node_map[link.m], shadow_node_map[link.n],
+                       link.bandwidth, residual, blocked, no_removed_edge,
+                       &shadow_path)) {
+        chosen = i;
+        break;
+      }
+    }
+    const Path &path = candidates[chosen];
+    reserve(path, link.bandwidth);
+    for (int uv : path) working_node[pn_.head(uv)] = true;
+    embedding->edge_map[std::make_pair(link.m, link.n)] = to_links(path);
+    embedding->cost += link.bandwidth * PathCost(path);
+  }
+  for (auto &link : links) {
+    Path path;
+    if (!ShortestPath(shadow_node_map[link.m], shadow_node_map[link.n],
+                      link.bandwidth, residual, working_node, no_removed_edge,
+                      &path)) {
+      return false;
+    }
+    reserve(path, link.bandwidth);
+    embedding->shadow_edge_map[std::make_pair(link.m, link.n)] =
+        to_links(path);
+    embedding->cost += link.bandwidth * PathCost(path);
+  }
+  return true;
+}
+
+void VNEProtectionHeuristicSolver::RunDijkstra(
+    int source, int destination, long bandwidth,
+    const std::vector<long> &residual, const std::vector<bool> &blocked_node,
+    const std::vector<bool> &removed_edge, std::vector<long> *distance,
+    std::vector<int> *previous_edge) const {
+  typedef std::pair<long, int> QueueEntry;
+  std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                      std::greater<QueueEntry> > queue;
+  distance->assign(physical_topology_->node_count(), kUnreachable);
+  previous_edge->assign(physical_topology_->node_count(), NIL);
+  distance->at(source) = 0;
+  queue.push(std::make_pair(0, source));
+  while (!queue.empty()) {
+    long d = queue.top().first;
+    int u = queue.top().second;
+    queue.pop();
+    if (d > distance->at(u)) continue;
+    if (u == destination) break;
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      int v = pn_.head(uv);
+      if (removed_edge[uv] || blocked_node[v] || residual[uv] < bandwidth) {
+        continue;
+      }
+      long v_distance = d + pn_.cost(uv);
+      if (v_distance < distance->at(v)) {
+        distance->at(v) = v_distance;
+        previous_edge->at(v) = uv;
+        queue.push(std::make_pair(v_distance, v));
+      }
+    }
+  }
+}
+
+bool VNEProtectionHeuristicSolver::ShortestPath(
+    int source, int destination, long bandwidth,
+    const std::vector<long> &residual, const std::vector<bool> &blocked_node,
+    const std::vector<bool> &removed_edge, Path *path) const {
+  std::vector<long> distance;
+  std::vector<int> previous_edge;
+  RunDijkstra(source, destination, bandwidth, residual, blocked_node,
+              removed_edge, &distance, &previous_edge);
+  path->clear();
+  if (distance[destination] == kUnreachable) return false;
+  for (int v = destination; v != source; v = pn_.tail(previous_edge[v])) {
+    path->push_back(previous_edge[v]);
+  }
+  std::reverse(path->begin(), path->end());
+  return true;
+}
+
+void VNEProtectionHeuristicSolver::KShortestPaths(
+    int source, int destination, long bandwidth,
+    const std::vector<long> &residual, const std::vector<bool> &blocked_node,
+    int k, std::vector<Path> *paths) const {
+  paths->clear();
+  std::vector<bool> no_removed_edge(pn_.edge_count(), false);
+  Path path;
+  if (!ShortestPath(source, destination, bandwidth, residual, blocked_node,
+                    no_removed_edge, &path)) {
+    return;
+  }
+  paths->push_back(path);
+  std::vector<std::pair<long, Path> > candidates;
+  while (paths->size() < k) {
+    Path previous = paths->back();
+    // Deviate from the previous path at each of its nodes. The part before
+    // the spur node is kept, and its nodes are blocked to keep the path
+    // loopless.
+    std::vector<bool> spur_blocked = blocked_node;
+    for (int i = 0; i < previous.size(); ++i) {
+      int spur_node = pn_.tail(previous[i]);
+      Path root(previous.begin(), previous.begin() + i);
+      std::vector<bool> removed_edge(pn_.edge_count(), false);
+      for (auto &p : *paths) {
+        if (p.size() > i && std::equal(root.begin(), root.end(), p.begin())) {
+          removed_edge[p[i]] = true;
+        }
+      }
+      spur_blocked[spur_node] = true;
+      Path spur_path;
+      if (ShortestPath(spur_node, destination, bandwidth, residual,
+                       spur_blocked, removed_edge, &spur_path)) {
+        root.insert(root.end(), spur_path.begin(), spur_path.end());
+        bool is_new = std::find(paths->begin(), paths->end(), root) ==
+                      paths->end();
+        for (auto &candidate : candidates) {
+          if (candidate.second == root) is_new = false;
+        }
+        if (is_new) candidates.push_back(std::make_pair(PathCost(root), root));
+      }
+    }
+    if (candidates.empty()) break;
+    auto best = std::min_element(candidates.begin(), candidates.end());
+    paths->push_back(best->second);
+    candidates.erase(best);
+  }
+}
+
+long VNEProtectionHeuristicSolver::Distance(int u, int v) {
+  if (distance_[u].empty()) {
+    std::vector<long> residual(pn_.edge_count(), 0);
+    std::vector<bool> no_blocked_node(physical_topology_->node_count(), false);
+    std::vector<bool> no_removed_edge(pn_.edge_count(), false);
+    std::vector<int> previous_edge;
+    RunDijkstra(u, NIL, 0, residual, no_blocked_node, no_removed_edge,
+                &distance_[u], &previous_edge);
+  }
+  return distance_[u][v];
+}
+
+long VNEProtectionHeuristicSolver::PathCost(const Path &path) const {
+  long cost = 0;
+  for (int uv : path) cost += pn_.cost(uv);
+  return cost;
+}
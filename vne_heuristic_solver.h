@@ -0,0 +1,87 @@
+#ifndef VNE_HEURISTIC_SOLVER_H_
+#define VNE_HEURISTIC_SOLVER_H_
+
+#include "datastructure.h"
+
+#include <vector>
+
+// Greedy embedding of a virtual network with 1 + 1 protection that works
+// directly on a compact copy of the physical topology and obeys the rules of
+// the ILP model in VNEProtectionSolver: every working and shadow virtual node
+// is mapped to a distinct physical node of its location constraint, virtual
+// links are mapped to paths with enough bandwidth, and shadow links and nodes
+// avoid every physical node used by the working network.
+//
+// Virtual nodes are mapped close to their already mapped neighbors. Working
+// links are then routed on one of the k shortest paths, picking the first one
+// that leaves a path for the corresponding shadow link, and shadow links are
+// routed on shortest paths avoiding the working network. Each attempt differs
+// in which virtual node has its working and shadow host swapped; the cheapest
+// successful attempt is kept.
+class VNEProtectionHeuristicSolver {
+ public:
+  VNEProtectionHeuristicSolver(
+      Graph *physical_topology, Graph *virt_topology,
+      std::vector<std::vector<int> > *location_constraint);
+
+  // Returns true if an embedding has been found.
+  bool Solve();
+
+  // The embedding found by Solve(). Its status is "Successful" on success
+  // and "Unknown" otherwise, as a failure does not prove infeasibility.
+  const VNEmbedding &embedding() const { return embedding_; }
+
+ private:
+  // A path is a sequence of directed physical edge ids.
+  typedef std::vector<int> Path;
+
+  // Maps working and shadow virtual nodes. The working and shadow host of
+  // swapped_node are exchanged afterwards unless swapped_node is NIL.
+  bool MapNodes(int swapped_node, std::vector<int> *node_map,
+                std::vector<int> *shadow_node_map);
+  // Routes all virtual links for the given node mapping and stores the
+  // result in embedding. Returns false if a link cannot be routed.
+  bool MapLinks(const std::vector<int> &node_map,
+                const std::vector<int> &shadow_node_map,
+                VNEmbedding *embedding);
+
+  // Cheapest path from source to destination over edges with a residual
+  // bandwidth of at least bandwidth, not passing through blocked nodes or
+  // removed edges. Returns false if there is no such path.
+  bool ShortestPath(int source, int destination, long bandwidth,
+                    const std::vector<long> &residual,
+                    const std::vector<bool> &blocked_node,
+                    const std::vector<bool> &removed_edge, Path *path) const;
+  // Up to k cheapest loopless paths in increasing order of cost (Yen's
+  // algorithm) under the same restrictions as ShortestPath().
+  void KShortestPaths(int source, int destination, long bandwidth,
+                      const std::vector<long> &residual,
+                      const std::vector<bool> &blocked_node, int k,
+                      std::vector<Path> *paths) const;
+  // Dijkstra's algorithm from source on the edges that pass the same
+  // restrictions as in ShortestPath(). Stops early once destination, if not
+  // NIL, is settled. distance and previous_edge are indexed by node.
+  void RunDijkstra(int source, int destination, long bandwidth,
+                   const std::vector<long> &residual,
+                   const std::vector<bool> &blocked_node,
+                   const std::vector<bool> &removed_edge,
+                   std::vector<long> *distance,
+                   std::vector<int> *previous_edge) const;
+  // Cost of the cheapest path between u and v, ignoring bandwidth.
+  long Distance(int u, int v);
+  long PathCost(const Path &path) const;
+
+  Graph *physical_topology_;
+  Graph *virt_topology_;
+  std::vector<std::vector<int> > *location_constraint_;
+
+  // Compact copy of the physical topology; paths consist of its edge ids.
+  CompactGraph pn_;
+  // Cost of the cheapest path between two physical nodes, computed on
+  // demand for the nodes in location constraints.
+  std::vector<std::vector<long> > distance_;
+
+  VNEmbedding embedding_;
+};
+
+#endif  // VNE_HEURISTIC_SOLVER_H_
@@ -0,0 +1,514 @@
+#include "vne_path_solver.h"
+#include "util.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <math.h>
+#include <queue>
+
+namespace {
+// Limit on the number of LPs solved by column generation.
+const int kMaxIterations = 200;
+// A path enters the master if its reduced cost is below -kReducedCostTolerance
+// times its cost, which leaves room for rounding errors in the duals.
+const double kReducedCostTolerance = 1e-6;
+// A binary variable is taken as 1 above this value.
+const double kOneThreshold = 0.5;
+// Limit on the number of fixings a dive may revert.
+const int kMaxBacktracks = 20;
+// A value within this distance of an integer counts as integral.
+const double kIntegralityTolerance = 1e-6;
+const double kUnreachable = std::numeric_limits<double>::infinity();
+}  // namespace
+
+VNEPathSolver::VNEPathSolver(
+    MIPBackend *backend, Graph *physical_topology, Graph *virt_topology,
+    std::vector<std::vector<int>> *location_constraint)
+    : backend_(backend),
+      physical_topology_(physical_topology),
+      virt_topology_(virt_topology),
+      location_constraint_(location_constraint),
+      pn_(*physical_topology),
+      artificial_cost_(0.0),
+      start_cost_(kUnreachable),
+      iteration_count_(0),
+      is_converged_(false),
+      lower_bound_(-MIP_INFINITY) {
+  embedding_.status = "Unknown";
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    for (auto &end_point : virt_topology_->adj_list()->at(m)) {
+      if (m < end_point.node_id) continue;
+      VirtualLink link = {m, end_point.node_id, end_point.bandwidth};
+      links_.push_back(link);
+    }
+  }
+}
+
+int VNEPathSolver::AddVariable(VariableType type, double cost, bool is_path) {
+  int variable = backend_->AddVariable(0.0, 1.0, type);
+  if (cost != 0.0) objective_.AddTerm(variable, cost);
+  cost_.push_back(cost);
+  is_path_.push_back(is_path);
+  column_.push_back(std::vector<std::pair<int, double>>());
+  return variable;
+}
+
+int VNEPathSolver::AddRow(const LinearExpr &expr, ConstraintSense sense,
+                          double rhs) {
+  int row = backend_->AddConstraint(LinearConstraint(expr, sense, rhs));
+  for (auto &term : expr.terms) {
+    column_[term.first].push_back(std::make_pair(row, term.second));
+  }
+  sense_.push_back(sense);
+  rhs_.push_back(rhs);
+  return row;
+}
+
+void VNEPathSolver::SetCoefficient(int row, int variable,
+                                   double coefficient) {
+  backend_->SetCoefficient(row, variable, coefficient);
+  column_[variable].push_back(std::make_pair(row, coefficient));
+}
+
+void VNEPathSolver::BuildModel() {
+  int pn_node_count = pn_.node_count();
+  int vn_node_count = virt_topology_->node_count();
+  int flow_count = 2 * links_.size();
+  long total_bandwidth = 0;
+  for (auto &link : links_) total_bandwidth += link.bandwidth;
+  int max_cost = 0;
+  for (int uv = 0; uv < pn_.edge_count(); ++uv) {
+    max_cost = std::max(max_cost, pn_.cost(uv));
+  }
+  // A path has at most pn_node_count - 1 edges, so every working and shadow
+  // flow costs at most its bandwidth times that many of the costliest edge.
+  artificial_cost_ =
+      2.0 * total_bandwidth * max_cost * std::max(1, pn_node_count - 1) + 1.0;
+  is_bottleneck_.resize(pn_.edge_count());
+  for (int uv = 0; uv < pn_.edge_count(); ++uv) {
+    is_bottleneck_[uv] =
+        std::min(pn_.residual_bandwidth(uv),
+                 pn_.residual_bandwidth(pn_.reverse(uv))) < total_bandwidth;
+  }
+  w_.assign(pn_node_count, NIL);
+  node_row_.assign(flow_count * pn_node_count, NIL);
+  source_row_.assign(flow_count * pn_node_count, NIL);
+  destination_row_.assign(flow_count * pn_node_count, NIL);
+  capacity_row_.assign(2 * pn_.edge_count(), NIL);
+  known_paths_.resize(flow_count);
+
+  // Every working and shadow virtual node is mapped to one candidate, and
+  // every physical node hosts at most one of them.
+  y_.assign(vn_node_count * pn_node_count, NIL);
+  shadow_y_.assign(vn_node_count * pn_node_count, NIL);
+  std::vector<LinearExpr> hosted(pn_node_count);
+  for (int m = 0; m < vn_node_count; ++m) {
+    LinearExpr sum, shadow_sum;
+    for (int u : location_constraint_->at(m)) {
+      int i = m * pn_node_count + u;
+      y_[i] = AddVariable(kBinary, 0.0, false);
+      shadow_y_[i] = AddVariable(kBinary, 0.0, false);
+      backend_->SetPriority(y_[i], 1);
+      backend_->SetPriority(shadow_y_[i], 1);
+      sum.AddTerm(y_[i], 1.0);
+      shadow_sum.AddTerm(shadow_y_[i], 1.0);
+      hosted[u].AddTerm(y_[i], 1.0);
+      hosted[u].AddTerm(shadow_y_[i], 1.0);
+    }
+    AddRow(sum, kEqual, 1.0);
+    AddRow(shadow_sum, kEqual, 1.0);
+  }
+  for (int u = 0; u < pn_node_count; ++u) {
+    if (hosted[u].terms.size() > 2) AddRow(hosted[u], kLessEqual, 1.0);
+  }
+  // Working hosts belong to the working network, shadow hosts do not.
+  for (int m = 0; m < vn_node_count; ++m) {
+    for (int u : location_constraint_->at(m)) {
+      int i = m * pn_node_count + u;
+      LinearExpr working, shadow;
+      working.AddTerm(y_[i], 1.0);
+      working.AddTerm(W(u), -1.0);
+      AddRow(working, kLessEqual, 0.0);
+      shadow.AddTerm(shadow_y_[i], 1.0);
+      shadow.AddTerm(W(u), 1.0);
+      AddRow(shadow, kLessEqual, 1.0);
+    }
+  }
+  // The paths of a flow leaving u add up to the mapping of m to u, and
+  // those arriving at v to the mapping of n to v. Until there are such
+  // paths, an artificial variable stands in for them.
+  for (int flow = 0; flow < flow_count; ++flow) {
+    auto &link = links_[flow / 2];
+    auto &y = flow % 2 == 0 ? y_ : shadow_y_;
+    for (int end = 0; end < 2; ++end) {
+      int m = end == 0 ? link.m : link.n;
+      auto &rows = end == 0 ? source_row_ : destination_row_;
+      for (int u : location_constraint_->at(m)) {
+        int artificial = AddVariable(kContinuous, artificial_cost_, false);
+        artificials_.push_back(artificial);
+        LinearExpr sum;
+        sum.AddTerm(artificial, 1.0);
+        sum.AddTerm(y[m * pn_node_count + u], -1.0);
+        rows[flow * pn_node_count + u] = AddRow(sum, kEqual, 0.0);
+      }
+    }
+  }
+  backend_->SetObjective(objective_);
+}
+
+int VNEPathSolver::W(int u) {
+  if (w_[u] == NIL) w_[u] = AddVariable(kBinary, 0.0, false);
+  return w_[u];
+}
+
+int VNEPathSolver::NodeRow(int flow, int u) {
+  int &row = node_row_[flow * pn_.node_count() + u];
+  if (row == NIL) {
+    bool is_shadow = flow % 2 == 1;
+    LinearExpr sum;
+    sum.AddTerm(W(u), is_shadow ? 1.0 : -1.0);
+    row = AddRow(sum, kLessEqual, is_shadow ? 1.0 : 0.0);
+  }
+  return row;
+}
+
+int VNEPathSolver::CapacityRow(int uv, bool is_shadow) {
+  if (!is_bottleneck_[uv]) return NIL;
+  int link = std::min(uv, pn_.reverse(uv));
+  int &row = capacity_row_[2 * link + (is_shadow ? 1 : 0)];
+  if (row == NIL) {
+    long residual = std::min(pn_.residual_bandwidth(uv),
+                             pn_.residual_bandwidth(pn_.reverse(uv)));
+    row = AddRow(LinearExpr(), kLessEqual, residual);
+  }
+  return row;
+}
+
+int VNEPathSolver::AddPath(int flow, const Path &path) {
+  if (path.empty()) return NIL;
+  auto known_path = known_paths_[flow].find(path);
+  if (known_path != known_paths_[flow].end()) return known_path->second;
+  int pn_node_count = pn_.node_count();
+  int source_row = source_row_[flow * pn_node_count + pn_.tail(path[0])];
+  int destination_row =
+      destination_row_[flow * pn_node_count + pn_.head(path.back())];
+  if (source_row == NIL || destination_row == NIL) return NIL;
+  auto &link = links_[flow / 2];
+  bool is_shadow = flow % 2 == 1;
+  int variable =
+      AddVariable(kBinary, link.bandwidth * PathCost(path), true);
+  SetCoefficient(source_row, variable, 1.0);
+  SetCoefficient(destination_row, variable, 1.0);
+  SetCoefficient(NodeRow(flow, pn_.tail(path[0])), variable, 1.0);
+  for (int uv : path) {
+    SetCoefficient(NodeRow(flow, pn_.head(uv)), variable, 1.0);
+    int capacity_row = CapacityRow(uv, is_shadow);
+    if (capacity_row != NIL) {
+      SetCoefficient(capacity_row, variable, link.bandwidth);
+    }
+  }
+  Column column = {flow / 2, is_shadow, path, variable};
+  columns_.push_back(column);
+  known_paths_[flow][path] = variable;
+  return variable;
+}
+
+void VNEPathSolver::SetMIPStart(const VNEmbedding &embedding) {
+  int pn_node_count = pn_.node_count();
+  std::vector<int> ones;
+  std::vector<bool> is_working(pn_node_count, false);
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    int i = m * pn_node_count + embedding.node_map[m];
+    int shadow_i = m * pn_node_count + embedding.shadow_node_map[m];
+    if (y_[i] == NIL || shadow_y_[shadow_i] == NIL) return;
+    ones.push_back(y_[i]);
+    ones.push_back(shadow_y_[shadow_i]);
+    is_working[embedding.node_map[m]] = true;
+  }
+  for (int flow = 0; flow < 2 * links_.size(); ++flow) {
+    auto &link = links_[flow / 2];
+    auto &edge_map =
+        flow % 2 == 0 ? embedding.edge_map : embedding.shadow_edge_map;
+    auto physical_links = edge_map.find(std::make_pair(link.m, link.n));
+    if (physical_links == edge_map.end()) return;
+    Path path;
+    for (auto &physical_link : physical_links->second) {
+      int uv = pn_.edge_id(physical_link.first, physical_link.second);
+      if (uv == NIL) return;
+      path.push_back(uv);
+      if (flow % 2 == 0) is_working[physical_link.second] = true;
+    }
+    int variable = AddPath(flow, path);
+    if (variable == NIL) return;
+    ones.push_back(variable);
+  }
+  for (int u = 0; u < pn_node_count; ++u) {
+    if (is_working[u]) ones.push_back(W(u));
+  }
+  std::vector<double> values(backend_->num_variables(), 0.0);
+  for (int variable : ones) values[variable] = 1.0;
+  std::vector<std::pair<int, double> > start;
+  for (int i = 0; i < values.size(); ++i) {
+    start.push_back(std::make_pair(i, values[i]));
+  }
+  backend_->SetMIPStart(start);
+  backend_->SetCutoff(embedding.cost);
+  start_cost_ = embedding.cost;
+}
+
+double VNEPathSolver::Dual(const std::vector<double> &duals, int row) const {
+  if (row == NIL || row >= duals.size()) return 0.0;
+  return sense_[row] == kLessEqual ? std::min(0.0, duals[row]) : duals[row];
+}
+
+int VNEPathSolver::PricePaths(int flow, const std::vector<double> &duals,
+                              double *min_reduced_cost) {
+  int pn_node_count = pn_.node_count();
+  auto &link = links_[flow / 2];
+  bool is_shadow = flow % 2 == 1;
+  // The reduced cost of a path is its cost minus the duals of its rows. The
+  // duals of node and capacity rows are at most 0, which makes them
+  // non-negative node and edge weights of a shortest path search; edges
+  // without enough bandwidth are left out.
+  std::vector<double> edge_weight(pn_.edge_count(), kUnreachable);
+  for (int uv = 0; uv < pn_.edge_count(); ++uv) {
+    if (pn_.residual_bandwidth(uv) < link.bandwidth) continue;
+    int capacity_row = NIL;
+    if (is_bottleneck_[uv]) {
+      int i = 2 * std::min(uv, pn_.reverse(uv)) + (is_shadow ? 1 : 0);
+      capacity_row = capacity_row_[i];
+    }
+    edge_weight[uv] =
+        link.bandwidth * (pn_.cost(uv) - Dual(duals, capacity_row));
+  }
+  std::vector<double> node_weight(pn_node_count);
+  for (int u = 0; u < pn_node_count; ++u) {
+    node_weight[u] = -Dual(duals, node_row_[flow * pn_node_count + u]);
+  }
+
+  typedef std::pair<double, int> QueueEntry;
+  std::vector<double> distance;
+  std::vector<int> previous_edge;
+  int added = 0;
+  *min_reduced_cost = kUnreachable;
+  for (int u : location_constraint_->at(link.m)) {
+    std::priority_queue<QueueEntry, std::vector<QueueEntry>,
+                        std::greater<QueueEntry> > queue;
+    distance.assign(pn_node_count, kUnreachable);
+    previous_edge.assign(pn_node_count, NIL);
+    distance[u] = node_weight[u];
+    queue.push(std::make_pair(distance[u], u));
+    while (!queue.empty()) {
+      double d = queue.top().first;
+      int x = queue.top().second;
+      queue.pop();
+      if (d > distance[x]) continue;
+      for (int xy = pn_.begin(x); xy < pn_.end(x); ++xy) {
+        if (edge_weight[xy] == kUnreachable) continue;
+        int y = pn_.head(xy);
+        double y_distance = d + edge_weight[xy] + node_weight[y];
+        if (y_distance < distance[y]) {
+          distance[y] = y_distance;
+          previous_edge[y] = xy;
+          queue.push(std::make_pair(y_distance, y));
+        }
+      }
+    }
+    double source_dual =
+        Dual(duals, source_row_[flow * pn_node_count + u]);
+    for (int v : location_constraint_->at(link.n)) {
+      if (v == u || distance[v] == kUnreachable) continue;
+      double reduced_cost =
+          distance[v] - source_dual -
+          Dual(duals, destination_row_[flow * pn_node_count + v]);
+      *min_reduced_cost = std::min(*min_reduced_cost, reduced_cost);
+      if (reduced_cost >= -kReducedCostTolerance * std::max(1.0, distance[v])) {
+        continue;
+      }
+      Path path;
+      for (int x = v; x != u; x = pn_.tail(previous_edge[x])) {
+        path.push_back(previous_edge[x]);
+      }
+      std::reverse(path.begin(), path.end());
+      if (known_paths_[flow].count(path)) continue;
+      AddPath(flow, path);
+      ++added;
+    }
+  }
+  return added;
+}
+
+double VNEPathSolver::LagrangianBound(
+    const std::vector<double> &duals,
+    const std::vector<double> &min_reduced_cost) const {
+  // All variables lie in [0, 1], and the paths of a flow add up to at most 1
+  // since its hosts do.
+  double bound = 0.0;
+  for (int row = 0; row < duals.size(); ++row) {
+    bound += Dual(duals, row) * rhs_[row];
+  }
+  for (int variable = 0; variable < cost_.size(); ++variable) {
+    if (is_path_[variable]) continue;
+    double reduced_cost = cost_[variable];
+    for (auto &term : column_[variable]) {
+      reduced_cost -= Dual(duals, term.first) * term.second;
+    }
+    bound += std::min(0.0, reduced_cost);
+  }
+  for (double reduced_cost : min_reduced_cost) {
+    if (reduced_cost < 0.0) bound += reduced_cost;
+  }
+  return bound;
+}
+
+int VNEPathSolver::SolveAndPrice(std::vector<double> *values,
+                                 std::vector<double> *duals,
+                                 std::vector<double> *min_reduced_cost) {
+  backend_->SetObjective(objective_);
+  if (!backend_->SolveRelaxation(values, duals)) return -1;
+  int added = 0;
+  for (int flow = 0; flow < 2 * links_.size(); ++flow) {
+    added += PricePaths(flow, *duals, &min_reduced_cost->at(flow));
+  }
+  // The added paths are not part of the LP solution.
+  values->resize(backend_->num_variables(), 0.0);
+  return added;
+}
+
+bool VNEPathSolver::GeneratePaths() {
+  is_converged_ = false;
+  std::vector<double> values, duals;
+  std::vector<double> min_reduced_cost(2 * links_.size());
+  while (!is_converged_ && iteration_count_ < kMaxIterations) {
+    int added = SolveAndPrice(&values, &duals, &min_reduced_cost);
+    if (added < 0) return false;
+    ++iteration_count_;
+    lower_bound_ =
+        std::max(lower_bound_, LagrangianBound(duals, min_reduced_cost));
+    DEBUG("Iteration %d: %d paths added, lower bound = %lf\n",
+          iteration_count_, added, lower_bound_);
+    is_converged_ = added == 0;
+  }
+  return true;
+}
+
+void VNEPathSolver::Dive() {
+  std::vector<double> values, duals;
+  std::vector<double> min_reduced_cost(2 * links_.size());
+  // Variables fixed to 1 and to 0 by their bounds.
+  std::vector<int> ones, zeros;
+  int backtrack_count = 0;
+  bool is_integral = false;
+  while (!is_integral) {
+    int added = 0;
+    for (int i = 0; i < kMaxIterations; ++i) {
+      added = SolveAndPrice(&values, &duals, &min_reduced_cost);
+      if (added <= 0) break;
+    }
+    // The LP is infeasible, or only feasible with an artificial variable,
+    // if fixings conflict.
+    bool is_infeasible = added < 0;
+    for (int i = 0; !is_infeasible && i < artificials_.size(); ++i) {
+      is_infeasible = values[artificials_[i]] > kIntegralityTolerance;
+    }
+    if (is_infeasible) {
+      // No embedding is left after the last fixing to 1, so its variable is
+      // fixed to 0 instead.
+      if (ones.empty() || backtrack_count == kMaxBacktracks) break;
+      ++backtrack_count;
+      backend_->SetBounds(ones.back(), 0.0, 0.0);
+      zeros.push_back(ones.back());
+      ones.pop_back();
+      continue;
+    }
+    int fixed = NIL;
+    double fixed_value = 0.0;
+    auto consider = [&values, &fixed, &fixed_value](int variable) {
+      double value = values[variable];
+      if (value > fixed_value && value < 1.0 - kIntegralityTolerance) {
+        fixed = variable;
+        fixed_value = value;
+      }
+    };
+    for (auto &column : columns_) consider(column.variable);
+    for (int variable : y_) {
+      if (variable != NIL) consider(variable);
+    }
+    for (int variable : shadow_y_) {
+      if (variable != NIL) consider(variable);
+    }
+    if (fixed_value <= kIntegralityTolerance) {
+      is_integral = true;
+    } else {
+      backend_->SetBounds(fixed, 1.0, 1.0);
+      ones.push_back(fixed);
+    }
+  }
+  DEBUG("Dive: %d fixings, %d backtracks, %s\n", static_cast<int>(ones.size()),
+        backtrack_count, is_integral ? "integral" : "failed");
+  for (int variable : ones) backend_->SetBounds(variable, 0.0, 1.0);
+  for (int variable : zeros) backend_->SetBounds(variable, 0.0, 1.0);
+  if (!is_integral) return;
+  VNEmbedding embedding = ExtractEmbedding(values);
+  if (embedding.cost < start_cost_) SetMIPStart(embedding);
+}
+
+VNEmbedding VNEPathSolver::ExtractEmbedding(
+    const std::vector<double> &values) const {
+  VNEmbedding embedding;
+  int pn_node_count = pn_.node_count();
+  int vn_node_count = virt_topology_->node_count();
+  embedding.node_map.assign(vn_node_count, NIL);
+  embedding.shadow_node_map.assign(vn_node_count, NIL);
+  for (int m = 0; m < vn_node_count; ++m) {
+    for (int u : location_constraint_->at(m)) {
+      int i = m * pn_node_count + u;
+      if (values[y_[i]] > kOneThreshold) embedding.node_map[m] = u;
+      if (values[shadow_y_[i]] > kOneThreshold) {
+        embedding.shadow_node_map[m] = u;
+      }
+    }
+  }
+  for (auto &column : columns_) {
+    if (values[column.variable] <= kOneThreshold) continue;
+    auto &link = links_[column.link];
+    auto &edge_map =
+        column.is_shadow ? embedding.shadow_edge_map : embedding.edge_map;
+    auto &physical_links = edge_map[std::make_pair(link.m, link.n)];
+    for (int uv : column.path) {
+      physical_links.push_back(std::make_pair(pn_.tail(uv), pn_.head(uv)));
+    }
+    embedding.cost += link.bandwidth * PathCost(column.path);
+  }
+  return embedding;
+}
+
+bool VNEPathSolver::Solve() {
+  embedding_ = VNEmbedding();
+  embedding_.status = "Unknown";
+  if (lower_bound_ >= artificial_cost_) {
+    embedding_.status = "Infeasible";
+    return false;
+  }
+  Dive();
+  // A solution with an artificial variable is no embedding, so they are
+  // fixed to 0, which also keeps their cost out of the search.
+  for (int artificial : artificials_) {
+    backend_->SetBounds(artificial, 0.0, 0.0);
+  }
+  backend_->SetObjective(objective_);
+  if (!backend_->Solve()) return false;
+  std::vector<double> values;
+  backend_->GetValues(&values);
+  embedding_ = ExtractEmbedding(values);
+  embedding_.status =
+      embedding_.cost - lower_bound_ < 1.0 - 1e-6 ? "Optimal" : "Feasible";
+  return true;
+}
+
+long VNEPathSolver::PathCost(const Path &path) const {
+  long cost = 0;
+  for (int uv : path) cost += pn_.cost(uv);
+  return cost;
+}
@@ -0,0 +1,194 @@
+#ifndef VNE_PATH_SOLVER_H_
+#define VNE_PATH_SOLVER_H_
+
+#include "datastructure.h"
+#include "mip_backend.h"
+
+#include <map>
+#include <vector>
+
+// Path based model of embedding a virtual network with 1 + 1 protection,
+// solved by column generation. Instead of one variable per pair of virtual
+// and physical edge, as in VNEProtectionSolver, every working and shadow
+// virtual link chooses one of a set of candidate paths, and the sets grow
+// only by paths that can improve the LP relaxation. The rules are those of
+// the arc model: working and shadow virtual nodes are mapped to distinct
+// physical nodes of their location constraints, paths only use links with
+// enough residual bandwidth, capacities hold per link for either network,
+// and no physical node is used by both the working and the shadow network.
+//
+// The restricted master problem has binary node mapping variables y_m_u and
+// a binary variable per candidate path. A path from u to v for virtual link
+// (m, n) takes the place of the mapping of m to u and of n to v: the paths
+// of a link leaving u add up to y_m_u, those arriving at v to y_n_v. Binary
+// w_u is 1 if node u belongs to the working network; every path and host
+// forces it to 1 or 0. Rows on paths, i.e., node and capacity rows, are only
+// added once a path needs them. Artificial variables with a prohibitive
+// cost keep the master feasible before the paths it needs exist.
+//
+// GeneratePaths() solves the LP relaxation of the master and prices paths
+// with its duals by a shortest path search per candidate host of m, until
+// no path has a negative reduced cost. Solve() then solves the master as a
+// MIP over the generated paths (price-and-branch), which is exact if the
+// result matches the lower bound and a heuristic otherwise. As the paths of
+// a fractional LP solution need not combine into an embedding, it first
+// dives to one: it fixes paths and node mappings to 1 one at a time and
+// generates paths for the remaining flows, which gives the MIP a start and
+// the paths that the start needs. The bound is the
+// Lagrangian bound of the duals: it holds for all paths, priced or not, and
+// needs neither exact duals nor converged column generation.
+class VNEPathSolver {
+ public:
+  // backend must not contain a model yet.
+  VNEPathSolver(MIPBackend *backend, Graph *physical_topology,
+                Graph *virt_topology,
+                std::vector<std::vector<int>> *location_constraint);
+
+  // Adds the node mapping variables and the rows that do not depend on
+  // paths.
+  void BuildModel();
+  // Adds the paths of embedding, e.g., one found by
+  // VNEProtectionHeuristicSolver, to the master and passes it to the backend
+  // as a MIP start and its cost as the cutoff. Must be called after
+  // BuildModel().
+  void SetMIPStart(const VNEmbedding &embedding);
+  // Generates paths until none can improve the LP relaxation or
+  // kMaxIterations LPs have been solved. Returns false if an LP cannot be
+  // solved.
+  bool GeneratePaths();
+  // Dives to an embedding, then solves the master over the generated paths
+  // as a MIP without the artificial variables. Returns true if an embedding
+  // has been found.
+  bool Solve();
+
+  // The embedding found by Solve(). Its status is "Optimal" if its cost is
+  // less than 1 above lower_bound(), which suffices as costs are integral,
+  // "Feasible" if it is not, "Infeasible" if the bound proves that there is
+  // no embedding, and "Unknown" otherwise.
+  const VNEmbedding &embedding() const { return embedding_; }
+
+  MIPBackend *backend() { return backend_; }
+  int path_count() const { return columns_.size(); }
+  int iteration_count() const { return iteration_count_; }
+  // Whether the last LP priced no path, and the best lower bound on the
+  // cost of any embedding found by GeneratePaths().
+  bool is_converged() const { return is_converged_; }
+  double lower_bound() const { return lower_bound_; }
+
+ private:
+  // A path is a sequence of directed physical edge ids from the host of m to
+  // the host of n of virtual link (m, n).
+  typedef std::vector<int> Path;
+
+  struct VirtualLink {
+    int m, n;
+    long bandwidth;
+  };
+  // A path variable of the working or the shadow flow of a virtual link.
+  struct Column {
+    int link;
+    bool is_shadow;
+    Path path;
+    int variable;
+  };
+
+  // Index of the working or the shadow flow of a virtual link.
+  int Flow(int link, bool is_shadow) const {
+    return 2 * link + (is_shadow ? 1 : 0);
+  }
+  // Add variables and rows to the backend and keep a column wise copy of
+  // the master for LagrangianBound().
+  int AddVariable(VariableType type, double cost, bool is_path);
+  int AddRow(const LinearExpr &expr, ConstraintSense sense, double rhs);
+  void SetCoefficient(int row, int variable, double coefficient);
+  // Variable w_u, added when first needed.
+  int W(int u);
+  // Row "paths of flow through u - w_u <= 0" of a working flow, or "paths
+  // of flow through u + w_u <= 1" of a shadow flow.
+  int NodeRow(int flow, int u);
+  // Capacity row of the working or the shadow network on the link of
+  // physical edge uv, or NIL if the link has enough residual bandwidth for
+  // every virtual link.
+  int CapacityRow(int uv, bool is_shadow);
+  // Adds path as a variable of flow unless it is already one. Returns the
+  // variable, or NIL if the path does not connect candidate hosts.
+  int AddPath(int flow, const Path &path);
+
+  // Solves the LP relaxation of the master into *values and *duals and adds
+  // the paths of every flow with a negative reduced cost, see PricePaths().
+  // Returns the number of added paths, or -1 if the LP cannot be solved.
+  int SolveAndPrice(std::vector<double> *values, std::vector<double> *duals,
+                    std::vector<double> *min_reduced_cost);
+  // Fixes the fractional path or node mapping variable with the largest
+  // value to 1 and generates paths until the LP solution is integral, or
+  // gives up once it needs an artificial variable. An embedding found this
+  // way becomes the MIP start if it is cheaper than the current one. Fixings
+  // set the bounds of the variables, which are restored afterwards, so the
+  // dive adds no rows to the master.
+  void Dive();
+  // The embedding given by the values of the path and node mapping
+  // variables.
+  VNEmbedding ExtractEmbedding(const std::vector<double> &values) const;
+
+  // Dual of row in duals, projected onto the sign that gives a valid bound.
+  // Rows added after the LP was solved have a dual of 0.
+  double Dual(const std::vector<double> &duals, int row) const;
+  // Adds the paths of flow with a negative reduced cost under duals, at most
+  // one per candidate host of m, and stores the least reduced cost of any
+  // path of flow in *min_reduced_cost. Returns the number of added paths.
+  int PricePaths(int flow, const std::vector<double> &duals,
+                 double *min_reduced_cost);
+  // y b + sum of min(0, reduced cost) over the variables other than paths,
+  // plus the least reduced cost of a path per flow, whose paths add up to at
+  // most 1.
+  double LagrangianBound(const std::vector<double> &duals,
+                         const std::vector<double> &min_reduced_cost) const;
+  long PathCost(const Path &path) const;
+
+  MIPBackend *backend_;
+  Graph *physical_topology_;
+  Graph *virt_topology_;
+  std::vector<std::vector<int>> *location_constraint_;
+  CompactGraph pn_;
+  std::vector<VirtualLink> links_;
+
+  // Node mapping variables of the working and the shadow network, indexed
+  // by m * pn_.node_count() + u; NIL for nodes outside the location
+  // constraint.
+  std::vector<int> y_, shadow_y_;
+  // w_u per physical node, or NIL.
+  std::vector<int> w_;
+  // Rows linking the paths of a flow to the node mapping of its source and
+  // destination, and node rows, indexed by flow * pn_.node_count() + u; NIL
+  // if not (yet) added.
+  std::vector<int> source_row_, destination_row_, node_row_;
+  // Capacity rows indexed by 2 * uv + is_shadow for the smaller of the ids
+  // of the two directions of a link; NIL if not (yet) added.
+  std::vector<int> capacity_row_;
+  // Whether the capacity of a link may be exceeded, by directed edge id.
+  std::vector<bool> is_bottleneck_;
+  std::vector<Column> columns_;
+  // Variable of every path per flow.
+  std::vector<std::map<Path, int>> known_paths_;
+  std::vector<int> artificials_;
+  // Cost of an artificial variable, higher than that of any embedding.
+  double artificial_cost_;
+  // Cost of the MIP start, or infinity if there is none.
+  double start_cost_;
+  LinearExpr objective_;
+
+  // Column wise copy of the master: cost and (row, coefficient) pairs of
+  // every variable, and sense and right-hand side of every row.
+  std::vector<double> cost_;
+  std::vector<bool> is_path_;
+  std::vector<std::vector<std::pair<int, double>>> column_;
+  std::vector<ConstraintSense> sense_;
+  std::vector<double> rhs_;
+
+  int iteration_count_;
+  bool is_converged_;
+  double lower_bound_;
+  VNEmbedding embedding_;
+};
+
+#endif  // VNE_PATH_SOLVER_H_
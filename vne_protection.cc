@@ -1,15 +1,544 @@
-#include "cplex_solver.h"
 #include "datastructure.h"
 #include "io.h"
+#include "mip_backend.h"
+#include "run_profile.h"
 #include "util.h"
+#include "vne_batch.h"
+#include "vne_heuristic_solver.h"
+#include "vne_path_solver.h"
+#include "vne_protection_solver.h"
+#include "vne_server.h"
 #include "vne_solution_builder.h"
 
+#include <chrono>
 #include <iostream>
+#include <string.h>
+#include <unistd.h>
 
 const std::string kUsage = "./vne_protection "
                            "--pn_topology_file=<pn_topology_file>\n\t"
                            "--vn_topology_file=<vn_topology_file>\n\t"
-                           "--location_constraint_file=<location_constraint_file>";
+                           "--location_constraint_file=<location_constraint_file>\n\t"
+                           "[--solver=<ilp|heuristic|path>]\n\t"
+                           "[--backend=<cplex|bnb>]\n\t"
+                           "[--mip_start=<none|heuristic>]\n\t"
+                           "[--server=<stdin|socket_path>]\n\t"
+                           "[--reuse_model=<true|false>]\n\t"
+                           "[--batch=<testcase_root>]\n\t"
+                           "[--vn_list=<vn_list_file>]\n\t"
+                           "[--jobs=<number_of_parallel_instances>]\n\t"
+                           "[--results_file=<results_file>]\n\t"
+                           "[--benchmark_threads=<n1,n2,...>]\n\t"
+                           "[--build_threads=<threads>]\n\t"
+                           "[--benchmark_build_threads=<n1,n2,...>]\n\t"
+                           "[--formulation=<indicator|aggregated|"
+                           "disaggregated>]\n\t"
+                           "[--lazy_disjointness=<true|false>]\n\t"
+                           "[--symmetry_breaking=<true|false>]\n\t"
+                           "[--export_model=<model_file[.gz]>]\n\t"
+                           "[--solution_format=<text|json|binary>]\n\t"
+                           "[--print_solution=<true|false>]\n\t"
+                           "[--profile_file=<profile_file>]\n\t"
+                           "[--threads=<threads>]\n\t"
+                           "[--time_limit=<seconds>]\n\t"
+                           "[--mip_gap=<relative_gap>]\n\t"
+                           "[--node_file=<none|memory|disk|compressed_disk>]"
+                           "\n\t"
+                           "[--tree_memory_limit=<MB>]\n\t"
+                           "[--work_memory=<MB>]\n\t"
+                           "[--parallel_mode=<auto|deterministic|"
+                           "opportunistic>]";
+
+// Where and how solutions are written; mirrors the command line options of
+// the same names.
+struct OutputOptions {
+  SolutionFormat solution_format;
+  bool print_solution;
+  // If set, a RunProfile of every run is appended to this file.
+  std::string profile_file;
+};
+
+// Solves a single instance and writes the solution to files prefixed with
+// its virtual topology file name.
+void SolveInstance(const EmbeddingOptions &options,
+                   const OutputOptions &output_options,
+                   const TestCase &test_case, InstanceResult *result) {
+  RunProfile profile;
+  profile.AddField("pn_topology_file", test_case.pn_topology_file);
+  profile.AddField("vn_topology_file", test_case.vn_topology_file);
+  profile.AddField("solver", options.solver);
+  // Every run, including one with invalid input, appends one record.
+  auto write_profile = [&output_options, &profile](const std::string &status,
+                                                   double cost) {
+    if (output_options.profile_file.empty()) return;
+    profile.AddField("status", status);
+    profile.AddField("cost", cost);
+    if (!profile.AppendTo(output_options.profile_file)) {
+      printf("Cannot write %s\n", output_options.profile_file.c_str());
+    }
+  };
+  result->cost = 0.0;
+  result->variables = result->constraints = result->lazy_constraints = 0;
+  result->nodes = 0;
+  result->build_time = 0.0;
+  result->export_time = 0.0;
+  result->solve_time = 0.0;
+  result->root_bound = -MIP_INFINITY;
+  profile.StartPhase("parse");
+  auto physical_topology =
+      InitializeTopologyFromFile(test_case.pn_topology_file.c_str());
+  auto virt_topology =
+      InitializeTopologyFromFile(test_case.vn_topology_file.c_str());
+  std::unique_ptr<std::vector<std::vector<int> > > location_constraints;
+  if (physical_topology && virt_topology) {
+    location_constraints = InitializeVNLocationsFromFile(
+        test_case.location_constraint_file.c_str(),
+        virt_topology->node_count(), physical_topology->node_count());
+  }
+  if (!physical_topology || !virt_topology || !location_constraints) {
+    snprintf(result->status, sizeof(result->status), "Invalid input");
+    profile.EndPhase();
+    write_profile(result->status, 0.0);
+    return;
+  }
+  profile.EndPhase();
+  profile.AddField("pn_nodes", physical_topology->node_count());
+  profile.AddField("pn_links", physical_topology->edge_count());
+  profile.AddField("vn_nodes", virt_topology->node_count());
+  profile.AddField("vn_links", virt_topology->edge_count());
+  DEBUG(physical_topology->GetDebugString().c_str());
+  DEBUG(virt_topology->GetDebugString().c_str());
+  profile.StartPhase("shadow_topology");
+  std::unique_ptr<Graph> shadow_virt_topology(new Graph(*virt_topology));
+  profile.EndPhase();
+  std::unique_ptr<VNESolutionBuilder> solution_builder;
+  bool is_success = false;
+  if (options.solver == "heuristic") {
+    profile.StartPhase("solve");
+    auto heuristic_start_time = std::chrono::steady_clock::now();
+    VNEProtectionHeuristicSolver heuristic_solver(
+        physical_topology.get(), virt_topology.get(),
+        location_constraints.get());
+    is_success = heuristic_solver.Solve();
+    std::chrono::duration<double> heuristic_time =
+        std::chrono::steady_clock::now() - heuristic_start_time;
+    printf("Heuristic finished in %.3lf s\n", heuristic_time.count());
+    result->solve_time = heuristic_time.count();
+    profile.StartPhase("extract");
+    solution_builder.reset(new VNESolutionBuilder(
+        heuristic_solver.embedding(), physical_topology.get(),
+        virt_topology.get()));
+    // The heuristic builds no model.
+    profile.EndPhase();
+  } else if (options.solver == "path") {
+    auto backend = CreateMIPBackend(options.backend);
+    backend->SetParameters(options.mip_parameters);
+    profile.AddField("backend", options.backend);
+    auto end_phase = [&profile, &backend]() {
+      profile.EndPhase(backend->num_variables(), backend->num_constraints());
+    };
+    profile.StartPhase("build_model");
+    auto build_start_time = std::chrono::steady_clock::now();
+    VNEPathSolver path_solver(backend.get(), physical_topology.get(),
+                              virt_topology.get(), location_constraints.get());
+    path_solver.BuildModel();
+    std::chrono::duration<double> build_time =
+        std::chrono::steady_clock::now() - build_start_time;
+    end_phase();
+    result->build_time = build_time.count();
+    auto solve_start_time = std::chrono::steady_clock::now();
+    if (options.mip_start == "heuristic") {
+      profile.StartPhase("mip_start");
+      VNEProtectionHeuristicSolver heuristic_solver(
+          physical_topology.get(), virt_topology.get(),
+          location_constraints.get());
+      if (heuristic_solver.Solve()) {
+        printf("MIP start from heuristic with cost %lf\n",
+               heuristic_solver.embedding().cost);
+        path_solver.SetMIPStart(heuristic_solver.embedding());
+      } else {
+        printf("Heuristic found no MIP start\n");
+      }
+      end_phase();
+    }
+    profile.StartPhase("column_generation");
+    if (!path_solver.GeneratePaths()) printf("Cannot solve the LP\n");
+    end_phase();
+    std::chrono::duration<double> generation_time =
+        std::chrono::steady_clock::now() - solve_start_time;
+    printf("Column generation %s after %d iterations in %.3lf s: %d paths, "
+           "%d variables, %d constraints, lower bound = %lf\n",
+           path_solver.is_converged() ? "converged" : "stopped",
+           path_solver.iteration_count(), generation_time.count(),
+           path_solver.path_count(), backend->num_variables(),
+           backend->num_constraints(), path_solver.lower_bound());
+    profile.AddField("paths", path_solver.path_count());
+    profile.AddField("iterations", path_solver.iteration_count());
+    profile.StartPhase("solve");
+    is_success = path_solver.Solve();
+    end_phase();
+    std::chrono::duration<double> solve_time =
+        std::chrono::steady_clock::now() - solve_start_time;
+    result->solve_time = solve_time.count();
+    result->variables = backend->num_variables();
+    result->constraints = backend->num_constraints();
+    result->root_bound = path_solver.lower_bound();
+    result->nodes = backend->GetNodeCount();
+    profile.StartPhase("extract");
+    solution_builder.reset(new VNESolutionBuilder(
+        path_solver.embedding(), physical_topology.get(),
+        virt_topology.get()));
+    end_phase();
+  } else {
+    auto backend = CreateMIPBackend(options.backend);
+    backend->SetParameters(options.mip_parameters);
+    profile.AddField("backend", options.backend);
+    profile.AddField("formulation", FormulationName(options.formulation));
+    auto end_phase = [&profile, &backend]() {
+      profile.EndPhase(backend->num_variables(), backend->num_constraints());
+    };
+    profile.StartPhase("variables");
+    auto vne_solver = std::unique_ptr<VNEProtectionSolver>(
+        new VNEProtectionSolver(backend.get(), physical_topology.get(),
+                                virt_topology.get(),
+                                shadow_virt_topology.get(),
+                                location_constraints.get(),
+                                options.formulation));
+    vne_solver->set_lazy_disjointness(options.lazy_disjointness);
+    vne_solver->set_symmetry_breaking(options.symmetry_breaking);
+    end_phase();
+    profile.StartPhase("build_model");
+    auto build_start_time = std::chrono::steady_clock::now();
+    vne_solver->BuildModel(options.build_threads);
+    std::chrono::duration<double> build_time =
+        std::chrono::steady_clock::now() - build_start_time;
+    end_phase();
+    printf("Presolve removed %d of %d edge mapping and %d of %d node mapping "
+           "variables and %d redundant constraints\n",
+           vne_solver->removed_x_mn_uv_count(),
+           vne_solver->removed_x_mn_uv_count() + vne_solver->x_mn_uv_count(),
+           vne_solver->removed_y_m_u_count(),
+           vne_solver->removed_y_m_u_count() + vne_solver->y_m_u_count(),
+           vne_solver->redundant_constraint_count());
+    printf("Model built in %.3lf s: %d edge mapping variables, %d variables, "
+           "%d constraints, %d lazy constraints, peak RSS = %ld KB\n",
+           build_time.count(), vne_solver->x_mn_uv_count(),
+           backend->num_variables(), backend->num_constraints(),
+           backend->num_lazy_constraints(), GetPeakMemoryUsageKB());
+    result->build_time = build_time.count();
+    result->variables = backend->num_variables();
+    result->constraints = backend->num_constraints();
+    result->lazy_constraints = backend->num_lazy_constraints();
+    profile.AddField("lazy_constraints", result->lazy_constraints);
+    if (!options.export_model.empty()) {
+      // In batch mode every test case gets its own copy of the model.
+      std::string filename = options.export_model;
+      if (!test_case.directory.empty()) {
+        filename = test_case.directory + "/" + filename;
+      }
+      profile.StartPhase("export");
+      auto export_start_time = std::chrono::steady_clock::now();
+      if (backend->ExportModel(filename.c_str())) {
+        std::chrono::duration<double> export_time =
+            std::chrono::steady_clock::now() - export_start_time;
+        printf("Model exported to %s in %.3lf s\n", filename.c_str(),
+               export_time.count());
+        result->export_time = export_time.count();
+      } else {
+        printf("Cannot export model to %s\n", filename.c_str());
+      }
+      end_phase();
+    }
+    // Both reported times include the time spent on finding a MIP start.
+    auto solve_start_time = std::chrono::steady_clock::now();
+    if (options.mip_start == "heuristic") {
+      profile.StartPhase("mip_start");
+      VNEProtectionHeuristicSolver heuristic_solver(
+          physical_topology.get(), virt_topology.get(),
+          location_constraints.get());
+      if (heuristic_solver.Solve()) {
+        printf("MIP start from heuristic with cost %lf\n",
+               heuristic_solver.embedding().cost);
+        vne_solver->SetMIPStart(heuristic_solver.embedding());
+      } else {
+        printf("Heuristic found no MIP start\n");
+      }
+      end_phase();
+    }
+    std::chrono::duration<double> mip_start_time =
+        std::chrono::steady_clock::now() - solve_start_time;
+    profile.StartPhase("solve");
+    is_success = vne_solver->Solve();
+    end_phase();
+    std::chrono::duration<double> solve_time =
+        std::chrono::steady_clock::now() - solve_start_time;
+    if (backend->GetFirstIncumbentTime() >= 0) {
+      printf("Time to first incumbent = %.3lf s\n",
+             mip_start_time.count() + backend->GetFirstIncumbentTime());
+    }
+    if (backend->GetStatus() == "Optimal") {
+      printf("Time to optimal = %.3lf s\n", solve_time.count());
+    }
+    result->solve_time = solve_time.count();
+    result->root_bound = backend->GetRootBound();
+    if (result->root_bound > -MIP_INFINITY) {
+      printf("Root bound = %lf\n", result->root_bound);
+    }
+    result->nodes = backend->GetNodeCount();
+    printf("Branch-and-bound nodes = %ld\n", result->nodes);
+    profile.AddField("nodes", result->nodes);
+    if (vne_solver->symmetry_anchor() != NIL) {
+      printf("Symmetry broken on virtual node %d\n",
+             vne_solver->symmetry_anchor());
+    }
+    profile.StartPhase("extract");
+    solution_builder.reset(new VNESolutionBuilder(
+        vne_solver.get(), physical_topology.get(), virt_topology.get()));
+    end_phase();
+  }
+  if (is_success) printf("Run successfully completed.\n");
+  profile.StartPhase("write");
+  solution_builder->PrintSolution(output_options.print_solution);
+  if (!solution_builder->WriteSolution(output_options.solution_format,
+                                       test_case.vn_topology_file)) {
+    printf("Cannot write the solution of %s\n",
+           test_case.vn_topology_file.c_str());
+  }
+  profile.EndPhase();
+  auto &embedding = solution_builder->embedding();
+  snprintf(result->status, sizeof(result->status), "%s",
+           embedding.status.c_str());
+  result->cost = is_success ? embedding.cost : 0.0;
+  write_profile(embedding.status, result->cost);
+}
+
+// Solves test_case once with every number of threads in thread_counts and
+// prints the wall time, i.e., model building and solving, of every run and its
+// speedup over the first one.
+void RunThreadBenchmark(const EmbeddingOptions &options,
+                        const OutputOptions &output_options,
+                        const TestCase &test_case,
+                        const std::vector<int> &thread_counts) {
+  std::vector<InstanceResult> results(thread_counts.size());
+  for (int i = 0; i < thread_counts.size(); ++i) {
+    EmbeddingOptions run_options = options;
+    run_options.mip_parameters.threads = thread_counts[i];
+    printf("Benchmark run with %d threads\n", thread_counts[i]);
+    SolveInstance(run_options, output_options, test_case, &results[i]);
+  }
+  printf("threads,status,cost,wall_time,speedup\n");
+  for (int i = 0; i < thread_counts.size(); ++i) {
+    double wall_time = results[i].build_time + results[i].solve_time;
+    double base_time = results[0].build_time + results[0].solve_time;
+    printf("%d,%s,%lf,%.3lf,%.2lf\n", thread_counts[i], results[i].status,
+           results[i].cost, wall_time,
+           wall_time > 0.0 ? base_time / wall_time : 0.0);
+  }
+}
+
+// Builds the model of test_case with every number of threads in thread_counts
+// and prints the best BuildModel() wall time of a few runs with each and its
+// speedup over the first number of threads.
+bool RunBuildBenchmark(const EmbeddingOptions &options,
+                       const TestCase &test_case,
+                       const std::vector<int> &thread_counts) {
+  const int kRepetitions = 3;
+  auto physical_topology =
+      InitializeTopologyFromFile(test_case.pn_topology_file.c_str());
+  auto virt_topology =
+      InitializeTopologyFromFile(test_case.vn_topology_file.c_str());
+  if (!physical_topology || !virt_topology) return false;
+  auto location_constraints = InitializeVNLocationsFromFile(
+      test_case.location_constraint_file.c_str(), virt_topology->node_count(),
+      physical_topology->node_count());
+  if (!location_constraints) return false;
+  std::vector<double> build_times(thread_counts.size());
+  printf("build_threads,build_time,speedup,variables,constraints\n");
+  for (int i = 0; i < thread_counts.size(); ++i) {
+    int variables = 0, constraints = 0;
+    for (int run = 0; run < kRepetitions; ++run) {
+      auto backend = CreateMIPBackend(options.backend);
+      VNEProtectionSolver vne_solver(
+          backend.get(), physical_topology.get(), virt_topology.get(),
+          virt_topology.get(), location_constraints.get(),
+          options.formulation);
+      vne_solver.set_lazy_disjointness(options.lazy_disjointness);
+      vne_solver.set_symmetry_breaking(options.symmetry_breaking);
+      auto build_start_time = std::chrono::steady_clock::now();
+      vne_solver.BuildModel(thread_counts[i]);
+      std::chrono::duration<double> build_time =
+          std::chrono::steady_clock::now() - build_start_time;
+      if (run == 0 || build_time.count() < build_times[i]) {
+        build_times[i] = build_time.count();
+      }
+      variables = backend->num_variables();
+      constraints = backend->num_constraints();
+    }
+    printf("%d,%.3lf,%.2lf,%d,%d\n", thread_counts[i], build_times[i],
+           build_times[i] > 0.0 ? build_times[0] / build_times[i] : 0.0,
+           variables, constraints);
+  }
+  return true;
+}
+
+// Embeds the virtual networks listed in vn_list_file, one
+// "<vn_topology_file>,<location_constraint_file>" row each, jointly and
+// writes the solution of every one to files prefixed with its virtual
+// topology file name. Returns false if an input file cannot be read.
+bool SolveJointInstances(const EmbeddingOptions &options,
+                         const OutputOptions &output_options,
+                         const std::string &pn_topology_file,
+                         const std::string &vn_list_file) {
+  RunProfile profile;
+  profile.AddField("pn_topology_file", pn_topology_file);
+  profile.AddField("vn_list_file", vn_list_file);
+  profile.AddField("solver", options.solver);
+  profile.StartPhase("parse");
+  auto physical_topology =
+      InitializeTopologyFromFile(pn_topology_file.c_str());
+  auto vn_list = ReadCSVFile(vn_list_file.c_str());
+  if (!physical_topology || !vn_list) return false;
+  std::vector<std::string> vn_topology_files;
+  std::vector<std::unique_ptr<Graph> > virt_topologies;
+  std::vector<std::unique_ptr<std::vector<std::vector<int> > > >
+      location_constraints;
+  for (auto &row : *vn_list) {
+    if (row.size() < 2) {
+      printf("%s: expected <vn_topology_file>,<location_constraint_file>\n",
+             vn_list_file.c_str());
+      return false;
+    }
+    auto virt_topology = InitializeTopologyFromFile(row[0].c_str());
+    if (!virt_topology) return false;
+    auto location_constraint = InitializeVNLocationsFromFile(
+        row[1].c_str(), virt_topology->node_count(),
+        physical_topology->node_count());
+    if (!location_constraint) return false;
+    vn_topology_files.push_back(row[0]);
+    virt_topologies.push_back(std::move(virt_topology));
+    location_constraints.push_back(std::move(location_constraint));
+  }
+  if (virt_topologies.empty()) {
+    printf("%s lists no virtual networks\n", vn_list_file.c_str());
+    return false;
+  }
+  std::vector<Graph *> virt_topology_ptrs;
+  std::vector<std::vector<std::vector<int> > *> location_constraint_ptrs;
+  for (int i = 0; i < virt_topologies.size(); ++i) {
+    virt_topology_ptrs.push_back(virt_topologies[i].get());
+    location_constraint_ptrs.push_back(location_constraints[i].get());
+  }
+  profile.EndPhase();
+  profile.AddField("pn_nodes", physical_topology->node_count());
+  profile.AddField("pn_links", physical_topology->edge_count());
+  profile.AddField("vn_count", virt_topologies.size());
+
+  auto backend = CreateMIPBackend(options.backend);
+  backend->SetParameters(options.mip_parameters);
+  profile.AddField("backend", options.backend);
+  profile.AddField("formulation", FormulationName(options.formulation));
+  auto end_phase = [&profile, &backend]() {
+    profile.EndPhase(backend->num_variables(), backend->num_constraints());
+  };
+  profile.StartPhase("variables");
+  auto build_start_time = std::chrono::steady_clock::now();
+  VNEProtectionBatchSolver batch_solver(
+      backend.get(), physical_topology.get(), virt_topology_ptrs,
+      location_constraint_ptrs, options.formulation);
+  batch_solver.set_lazy_disjointness(options.lazy_disjointness);
+  batch_solver.set_symmetry_breaking(options.symmetry_breaking);
+  end_phase();
+  profile.StartPhase("build_model");
+  batch_solver.BuildModel(options.build_threads);
+  std::chrono::duration<double> build_time =
+      std::chrono::steady_clock::now() - build_start_time;
+  end_phase();
+  printf("Model for %d virtual networks built in %.3lf s: %d variables, "
+         "%d constraints, %d lazy constraints, peak RSS = %ld KB\n",
+         batch_solver.request_count(), build_time.count(),
+         backend->num_variables(), backend->num_constraints(),
+         backend->num_lazy_constraints(), GetPeakMemoryUsageKB());
+  profile.AddField("lazy_constraints", backend->num_lazy_constraints());
+  if (!options.export_model.empty()) {
+    profile.StartPhase("export");
+    if (!backend->ExportModel(options.export_model.c_str())) {
+      printf("Cannot export model to %s\n", options.export_model.c_str());
+    }
+    end_phase();
+  }
+  auto solve_start_time = std::chrono::steady_clock::now();
+  if (options.mip_start == "heuristic") {
+    profile.StartPhase("mip_start");
+    // Embed the virtual networks one after the other, each onto the
+    // bandwidth the previous ones left.
+    Graph residual_topology(*physical_topology);
+    std::vector<VNEmbedding> embeddings(virt_topologies.size());
+    int start_count = 0;
+    for (int i = 0; i < virt_topologies.size(); ++i) {
+      VNEProtectionHeuristicSolver heuristic_solver(
+          &residual_topology, virt_topology_ptrs[i],
+          location_constraint_ptrs[i]);
+      if (!heuristic_solver.Solve() ||
+          !residual_topology.ReserveEmbedding(
+              *virt_topology_ptrs[i], heuristic_solver.embedding())) {
+        continue;
+      }
+      embeddings[i] = heuristic_solver.embedding();
+      ++start_count;
+    }
+    printf("MIP start from heuristic embeds %d of %d virtual networks\n",
+           start_count, batch_solver.request_count());
+    batch_solver.SetMIPStart(embeddings);
+    end_phase();
+  }
+  profile.StartPhase("solve");
+  if (batch_solver.Solve()) printf("Run successfully completed.\n");
+  std::chrono::duration<double> solve_time =
+      std::chrono::steady_clock::now() - solve_start_time;
+  end_phase();
+  printf("Branch-and-bound nodes = %ld\n", backend->GetNodeCount());
+  profile.AddField("nodes", backend->GetNodeCount());
+
+  profile.StartPhase("extract");
+  std::vector<std::unique_ptr<VNESolutionBuilder> > solution_builders;
+  for (int i = 0; i < batch_solver.request_count(); ++i) {
+    solution_builders.emplace_back(new VNESolutionBuilder(
+        batch_solver.request(i), physical_topology.get(),
+        virt_topology_ptrs[i]));
+  }
+  end_phase();
+  profile.StartPhase("write");
+  int embedded_count = 0;
+  double total_cost = 0.0;
+  for (int i = 0; i < batch_solver.request_count(); ++i) {
+    printf("Virtual network %s\n", vn_topology_files[i].c_str());
+    auto &solution_builder = *solution_builders[i];
+    solution_builder.PrintSolution(output_options.print_solution);
+    if (!solution_builder.WriteSolution(output_options.solution_format,
+                                        vn_topology_files[i])) {
+      printf("Cannot write the solution of %s\n",
+             vn_topology_files[i].c_str());
+    }
+    auto &embedding = solution_builder.embedding();
+    if (!embedding.node_map.empty()) {
+      ++embedded_count;
+      total_cost += embedding.cost;
+    }
+  }
+  profile.EndPhase();
+  printf("Embedded %d of %d virtual networks with total cost %lf, solved in "
+         "%.3lf s\n",
+         embedded_count, batch_solver.request_count(), total_cost,
+         solve_time.count());
+  if (!output_options.profile_file.empty()) {
+    profile.AddField("embedded_count", embedded_count);
+    profile.AddField("cost", total_cost);
+    if (!profile.AppendTo(output_options.profile_file)) {
+      printf("Cannot write %s\n", output_options.profile_file.c_str());
+    }
+  }
+  return true;
+}
 
 int main(int argc, char *argv[]) {
   using std::string;
@@ -17,6 +546,16 @@ int main(int argc, char *argv[]) {
   string pn_topology_filename = "";
   string vn_topology_filename = "";
   string location_constraint_filename = "";
+  string server = "";
+  string batch_root = "";
+  string vn_list_filename = "";
+  string results_filename = "results.csv";
+  int jobs = 0;
+  std::vector<int> benchmark_threads;
+  std::vector<int> benchmark_build_threads;
+  EmbeddingOptions options;
+  if (!ParseEmbeddingOptions(arg_map.get(), &options)) return 1;
+  OutputOptions output_options = {kTextSolution, false};
   for (auto argument : *arg_map) {
     if (argument.first == "--pn_topology_file") {
       pn_topology_filename = argument.second;
@@ -24,58 +563,113 @@ int main(int argc, char *argv[]) {
       vn_topology_filename = argument.second;
     } else if (argument.first == "--location_constraint_file") {
       location_constraint_filename = argument.second;
+    } else if (argument.first == "--server") {
+      server = argument.second;
+    } else if (argument.first == "--batch") {
+      batch_root = argument.second;
+    } else if (argument.first == "--vn_list") {
+      vn_list_filename = argument.second;
+    } else if (argument.first == "--jobs") {
+      jobs = atoi(argument.second.c_str());
+    } else if (argument.first == "--solution_format") {
+      if (!ParseSolutionFormat(argument.second,
+                               &output_options.solution_format)) {
+        printf("Unknown solution format: %s\n", argument.second.c_str());
+        return 1;
+      }
+    } else if (argument.first == "--print_solution") {
+      output_options.print_solution = argument.second == "true";
+    } else if (argument.first == "--profile_file") {
+      output_options.profile_file = argument.second;
+    } else if (argument.first == "--results_file") {
+      results_filename = argument.second;
+    } else if (argument.first == "--benchmark_threads" ||
+               argument.first == "--benchmark_build_threads") {
+      auto &counts = argument.first == "--benchmark_threads"
+                         ? benchmark_threads
+                         : benchmark_build_threads;
+      string thread_counts = argument.second;
+      for (char *count = strtok(&thread_counts[0], ","); count;
+           count = strtok(NULL, ",")) {
+        counts.push_back(atoi(count));
+      }
     } else {
       printf("Invalid command line option: %s\n", argument.first.c_str());
       return 1;
     }
   }
-  auto physical_topology =
-      InitializeTopologyFromFile(pn_topology_filename.c_str());
-  DEBUG(physical_topology->GetDebugString().c_str());
-  auto virt_topology = InitializeTopologyFromFile(vn_topology_filename.c_str());
-  DEBUG(virt_topology->GetDebugString().c_str());
-  auto shadow_virt_topology =
-      InitializeTopologyFromFile(vn_topology_filename.c_str());
-  DEBUG(shadow_virt_topology->GetDebugString().c_str());
-  auto location_constraints = InitializeVNLocationsFromFile(
-      location_constraint_filename.c_str(), virt_topology->node_count());
-  auto vne_cplex_solver =
-      std::unique_ptr<VNEProtectionCPLEXSolver>(new VNEProtectionCPLEXSolver(
-          physical_topology.get(), virt_topology.get(),
-          shadow_virt_topology.get(), location_constraints.get()));
-  try {
-    auto &cplex_env = vne_cplex_solver->env();
-    vne_cplex_solver->BuildModel();
-    bool is_success = vne_cplex_solver->Solve();
-    if (!is_success) {
-      auto &cplex = vne_cplex_solver->cplex();
-      std::cout << "Solution status: " << cplex.getStatus() << std::endl;
-      std::cout << "X : " << cplex.getCplexStatus() << std::endl;
-      auto solution_builder = std::unique_ptr<VNESolutionBuilder>(
-          new VNESolutionBuilder(vne_cplex_solver.get(),
-            physical_topology.get(), virt_topology.get()));
-      solution_builder->PrintSolutionStatus(
-          (vn_topology_filename + ".status").c_str());
-    } else {
-      printf("Run successfully completed.\n");
-      auto solution_builder = std::unique_ptr<VNESolutionBuilder>(
-          new VNESolutionBuilder(vne_cplex_solver.get(),
-                                 physical_topology.get(), virt_topology.get()));
-      solution_builder->PrintCost((vn_topology_filename + ".cost").c_str());
-      solution_builder->PrintWorkingNodeMapping((vn_topology_filename + ".nmap")
-                                                    .c_str());
-      solution_builder->PrintWorkingEdgeMapping((vn_topology_filename + ".emap")
-                                                    .c_str());
-      solution_builder->PrintShadowNodeMapping((vn_topology_filename + ".snmap")
-                                                   .c_str());
-      solution_builder->PrintShadowEdgeMapping((vn_topology_filename + ".semap")
-                                                   .c_str());
-      solution_builder->PrintSolutionStatus((vn_topology_filename + ".status")
-                                                .c_str());
-    }
-  }
-  catch (IloException & e) {
-    printf("Exception thrown: %s\n", e.getMessage());
-  }
-  return 0;
+  if (!vn_list_filename.empty()) {
+    if (options.solver != "ilp") {
+      printf("--vn_list requires --solver=ilp\n");
+      return 1;
+    }
+    return SolveJointInstances(options, output_options, pn_topology_filename,
+                               vn_list_filename)
+               ? 0
+               : 1;
+  }
+  if (!batch_root.empty()) {
+    // Instances share the processors: each gets one thread unless told
+    // otherwise, and as many run at a time as there are threads to spare.
+    int &threads = options.mip_parameters.threads;
+    if (threads <= 0) threads = 1;
+    if (jobs <= 0) {
+      jobs = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN) / threads);
+    }
+    auto test_cases = FindTestCases(batch_root);
+    printf("Running %d test cases, %d at a time with %d threads each\n",
+           static_cast<int>(test_cases.size()), jobs, threads);
+    auto start_time = std::chrono::steady_clock::now();
+    if (!RunBatch(test_cases, jobs, results_filename,
+                  [&options, &output_options](const TestCase &test_case,
+                                              InstanceResult *result) {
+                    SolveInstance(options, output_options, test_case, result);
+                  })) {
+      printf("Cannot write %s\n", results_filename.c_str());
+      return 1;
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    printf("Batch finished in %.3lf s, results written to %s\n",
+           elapsed.count(), results_filename.c_str());
+    return 0;
+  }
+  if (!server.empty()) {
+    auto physical_topology =
+        InitializeTopologyFromFile(pn_topology_filename.c_str());
+    if (!physical_topology) return 1;
+    DEBUG(physical_topology->GetDebugString().c_str());
+    VNEServer vne_server(physical_topology.get(), options);
+    if (server != "stdin") {
+      return vne_server.ServeUnixSocket(server.c_str()) ? 0 : 1;
+    }
+    // Responses go to the original standard output; everything else that is
+    // printed, e.g., solver logs, is redirected to standard error.
+    FILE *out = fdopen(dup(STDOUT_FILENO), "w");
+    dup2(STDERR_FILENO, STDOUT_FILENO);
+    vne_server.Serve(stdin, out);
+    fclose(out);
+    return 0;
+  }
+  TestCase test_case;
+  test_case.pn_topology_file = pn_topology_filename;
+  test_case.vn_topology_file = vn_topology_filename;
+  test_case.location_constraint_file = location_constraint_filename;
+  if (!benchmark_build_threads.empty()) {
+    return RunBuildBenchmark(options, test_case, benchmark_build_threads)
+               ? 0
+               : 1;
+  }
+  if (!benchmark_threads.empty()) {
+    RunThreadBenchmark(options, output_options, test_case,
+                       benchmark_threads);
+    return 0;
+  }
+  InstanceResult result;
+  SolveInstance(options, output_options, test_case, &result);
+  // Finding no embedding is a result, unreadable input or a solver error is
+  // not.
+  bool is_failed = !strcmp(result.status, "Invalid input") ||
+                   !strcmp(result.status, "Error");
+  return is_failed ? 1 : 0;
 }
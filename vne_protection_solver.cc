@@ -0,0 +1,1018 @@
+#include "vne_protection_solver.h"
+
+#include <algorithm>
+#include <map>
+#include <unistd.h>
+
+namespace {
+// Returns the constraint sum(coefficient * variable) (<=, >=, ==) rhs.
+LinearConstraint Constraint(const LinearExpr &expr, ConstraintSense sense,
+                            double rhs) {
+  return LinearConstraint(expr, sense, rhs);
+}
+
+LinearExpr Var(int variable) {
+  LinearExpr expr;
+  expr.AddTerm(variable, 1.0);
+  return expr;
+}
+}  // namespace
+
+bool ParseFormulation(const std::string &name, Formulation *formulation) {
+  if (name == "indicator") {
+    *formulation = kIndicatorFormulation;
+  } else if (name == "aggregated") {
+    *formulation = kAggregatedFormulation;
+  } else if (name == "disaggregated") {
+    *formulation = kDisaggregatedFormulation;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *FormulationName(Formulation formulation) {
+  switch (formulation) {
+    case kAggregatedFormulation:
+      return "aggregated";
+    case kDisaggregatedFormulation:
+      return "disaggregated";
+    default:
+      return "indicator";
+  }
+}
+
+VNEProtectionSolver::VNEProtectionSolver(
+    MIPBackend *backend, Graph *physical_topology, Graph *virt_topology,
+    Graph *shadow_virt_topology,
+    std::vector<std::vector<int>> *location_constraint,
+    Formulation formulation, int admit_variable) {
+  backend_ = backend;
+  physical_topology_ = physical_topology;
+  virt_topology_ = virt_topology;
+  shadow_virt_topology_ = shadow_virt_topology;
+  location_constraint_ = location_constraint;
+  formulation_ = formulation;
+  lazy_disjointness_ = false;
+  symmetry_breaking_ = false;
+  symmetry_anchor_ = NIL;
+  admit_variable_ = admit_variable;
+  redundant_constraint_count_ = 0;
+
+  // Assign ids to the directed edges of both topologies. The physical ones
+  // are those of its compact copy.
+  pn_ = CompactGraph(*physical_topology_);
+  pn_edge_count_ = pn_.edge_count();
+  first_variable_ = backend_->num_variables();
+  AddVariables();
+}
+
+VNEProtectionSolver::VNEProtectionSolver(MIPBackend *backend,
+                                         Graph *physical_topology,
+                                         Formulation formulation) {
+  backend_ = backend;
+  physical_topology_ = physical_topology;
+  virt_topology_ = shadow_virt_topology_ = NULL;
+  location_constraint_ = NULL;
+  formulation_ = formulation;
+  lazy_disjointness_ = false;
+  symmetry_breaking_ = false;
+  symmetry_anchor_ = NIL;
+  admit_variable_ = NIL;
+  redundant_constraint_count_ = 0;
+  x_count_ = y_count_ = vn_edge_count_ = 0;
+
+  pn_ = CompactGraph(*physical_topology_);
+  pn_edge_count_ = pn_.edge_count();
+  first_variable_ = backend_->num_variables();
+  // Only the capacity constraints are kept, starting without terms;
+  // BuildModel() adds those of every virtual network. The variables per
+  // physical node and edge are added with those of every virtual network, so
+  // that the variables, and with them the search of the backend, are ordered
+  // as in a model that is built from scratch.
+  capacity_row_.assign(pn_edge_count_, NIL);
+  for (int u = 0; u < pn_.node_count(); ++u) {
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      if (u > pn_.head(uv)) continue;
+      long beta_uv = pn_.residual_bandwidth(uv);
+      int row = backend_->AddConstraint(
+          Constraint(LinearExpr(), kLessEqual, beta_uv));
+      backend_->AddConstraint(Constraint(LinearExpr(), kLessEqual, beta_uv));
+      capacity_row_[uv] = capacity_row_[pn_.reverse(uv)] = row;
+    }
+  }
+  backend_->SetRollBackPoint();
+}
+
+void VNEProtectionSolver::SetVirtualNetwork(
+    Graph *virt_topology, Graph *shadow_virt_topology,
+    std::vector<std::vector<int>> *location_constraint) {
+  backend_->RollBack();
+  virt_topology_ = virt_topology;
+  shadow_virt_topology_ = shadow_virt_topology;
+  location_constraint_ = location_constraint;
+  redundant_constraint_count_ = 0;
+  objective_ = LinearExpr();
+
+  // Bandwidth may have been reserved or released since the last virtual
+  // network.
+  pn_.UpdateResidualBandwidth(*physical_topology_);
+  for (int u = 0; u < pn_.node_count(); ++u) {
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      if (u > pn_.head(uv)) continue;
+      backend_->SetRHS(capacity_row_[uv], pn_.residual_bandwidth(uv));
+      backend_->SetRHS(capacity_row_[uv] + 1, pn_.residual_bandwidth(uv));
+    }
+  }
+  AddVariables();
+}
+
+void VNEProtectionSolver::AddVariables() {
+  int first_y_m_u = AddVirtualNetworkVariables();
+  AddPhysicalVariables();
+  // Once the nodes are mapped, the remaining problem is a pair of disjoint
+  // path problems, so branch on the node mapping first.
+  for (int var = first_y_m_u; var < w_u_ + pn_.node_count(); ++var) {
+    backend_->SetPriority(var, 1);
+  }
+}
+
+int VNEProtectionSolver::AddVirtualNetworkVariables() {
+  vn_edge_count_ = 0;
+  vn_edge_offset_.resize(virt_topology_->node_count());
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    vn_edge_offset_[m] = vn_edge_count_;
+    vn_edge_count_ += virt_topology_->adj_list()->at(m).size();
+  }
+
+  l_m_u_.assign(virt_topology_->node_count() * 2,
+                std::vector<int>(physical_topology_->node_count(), 0));
+  int offset = virt_topology_->node_count();
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    auto loc_constraints = location_constraint_->at(m);
+    for (auto &u : loc_constraints) {
+      l_m_u_[m][u] = 1;
+      l_m_u_[m + offset][u] = 1;
+    }
+  }
+
+  // Decision variable initialization for virtual network and shadow virtual
+  // network. Multiply by two for the double number of virtual edges and
+  // nodes when considering the shadow network. Only the mappings kept by
+  // Presolve() get a variable.
+  Presolve();
+  for (auto &var : x_) {
+    if (var != NIL) var = backend_->AddVariable(0, 1, kBinary);
+  }
+  int first_y_m_u = backend_->num_variables();
+  for (auto &var : y_) {
+    if (var != NIL) var = backend_->AddVariable(0, 1, kBinary);
+  }
+  return first_y_m_u;
+}
+
+void VNEProtectionSolver::AddPhysicalVariables() {
+  w_u_ = backend_->num_variables();
+  for (int u = 0; u < physical_topology_->node_count(); ++u) {
+    backend_->AddVariable(0, 1, kBinary);
+  }
+  z_uv_ = -1;
+  if (formulation_ != kIndicatorFormulation) {
+    z_uv_ = backend_->num_variables();
+    for (int uv = 0; uv < pn_edge_count_; ++uv) {
+      backend_->AddVariable(0, 1, kBinary);
+    }
+  }
+}
+
+void VNEProtectionSolver::Presolve() {
+  int offset = virt_topology_->node_count();
+  int pn_node_count = physical_topology_->node_count();
+  x_.assign(vn_edge_count_ * 2 * pn_edge_count_, NIL);
+  y_.assign(virt_topology_->node_count() * 2 * pn_node_count, NIL);
+  x_count_ = y_count_ = 0;
+
+  // A virtual node can only be mapped to one of its locations that has a
+  // link with enough residual bandwidth for each of its virtual links.
+  std::vector<long> max_residual_bandwidth(pn_node_count, 0);
+  for (int u = 0; u < pn_node_count; ++u) {
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      max_residual_bandwidth[u] =
+          std::max(max_residual_bandwidth[u], pn_.residual_bandwidth(uv));
+    }
+  }
+  std::vector<std::vector<int> > candidates(virt_topology_->node_count());
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    long max_bandwidth = 0;
+    for (auto &end_point : virt_topology_->adj_list()->at(m)) {
+      max_bandwidth = std::max(max_bandwidth, end_point.bandwidth);
+    }
+    for (int u = 0; u < pn_node_count; ++u) {
+      if (!l_m_u_[m][u] || max_residual_bandwidth[u] < max_bandwidth) continue;
+      candidates[m].push_back(u);
+      y_[m * pn_node_count + u] = y_[(m + offset) * pn_node_count + u] = 0;
+      y_count_ += 2;
+    }
+  }
+
+  // A virtual link can only be mapped to physical links that lie on a simple
+  // path between a candidate of either end. Those are the links of the
+  // biconnected components on the path between the candidates in the tree of
+  // components and nodes (block-cut tree). Only the (m, n) direction with
+  // m > n is charged against the capacity of a link, so its tree is built
+  // from the physical links with enough residual bandwidth, once per
+  // bandwidth demand; the (n, m) direction may use any link.
+  struct BlockCutTree {
+    std::vector<std::vector<int> > component;
+    // Nodes 0, ..., pn_node_count - 1 are physical nodes, the following ones
+    // are components.
+    std::vector<std::vector<int> > adjacent;
+  };
+  std::map<long, BlockCutTree> trees;
+  std::vector<int> parent;
+  std::vector<bool> is_on_path;
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    auto &m_neighbors = virt_topology_->adj_list()->at(m);
+    for (int j = 0; j < m_neighbors.size(); ++j) {
+      int n = m_neighbors[j].node_id;
+      if (m < n) continue;
+      int mn = vn_edge_offset_[m] + j;
+      int nm = VirtualEdgeId(n, m);
+      for (int vedge : {mn, nm}) {
+        long min_bandwidth = vedge == mn ? m_neighbors[j].bandwidth : 0;
+        if (trees.find(min_bandwidth) == trees.end()) {
+          auto &tree = trees[min_bandwidth];
+          int component_count = physical_topology_->GetBiconnectedComponents(
+              min_bandwidth, &tree.component);
+          tree.adjacent.resize(pn_node_count + component_count);
+          for (int u = 0; u < pn_node_count; ++u) {
+            for (int block : tree.component[u]) {
+              if (block == NIL) continue;
+              auto &u_blocks = tree.adjacent[u];
+              if (std::find(u_blocks.begin(), u_blocks.end(),
+                            pn_node_count + block) != u_blocks.end()) {
+                continue;
+              }
+              u_blocks.push_back(pn_node_count + block);
+              tree.adjacent[pn_node_count + block].push_back(u);
+            }
+          }
+        }
+        auto &tree = trees[min_bandwidth];
+        is_on_path.assign(tree.adjacent.size(), false);
+        for (int s : candidates[m]) {
+          // Breadth-first search from s, then mark the path to every t.
+          parent.assign(tree.adjacent.size(), NIL);
+          parent[s] = s;
+          std::vector<int> queue(1, s);
+          for (int i = 0; i < queue.size(); ++i) {
+            for (int next : tree.adjacent[queue[i]]) {
+              if (parent[next] != NIL) continue;
+              parent[next] = queue[i];
+              queue.push_back(next);
+            }
+          }
+          for (int t : candidates[n]) {
+            if (parent[t] == NIL) continue;
+            for (int node = t; node != s; node = parent[node]) {
+              is_on_path[node] = true;
+            }
+          }
+        }
+        for (int u = 0; u < pn_node_count; ++u) {
+          auto &u_blocks = tree.component[u];
+          for (int i = 0; i < u_blocks.size(); ++i) {
+            if (u_blocks[i] == NIL ||
+                !is_on_path[pn_node_count + u_blocks[i]]) {
+              continue;
+            }
+            int uv = pn_.begin(u) + i;
+            x_[vedge * pn_edge_count_ + uv] = 0;
+            x_[(vedge + vn_edge_count_) * pn_edge_count_ + uv] = 0;
+            x_count_ += 2;
+          }
+        }
+      }
+    }
+  }
+}
+
+void VNEProtectionSolver::ModelRows::AddConstraint(
+    const LinearConstraint &constraint) {
+  LinearConstraint row(LinearExpr(), constraint.sense, constraint.rhs);
+  row.expr.constant = constraint.expr.constant;
+  // Every variable is binary, so the activity of the row lies between the
+  // sums of its negative and positive coefficients.
+  double min_activity = row.expr.constant, max_activity = row.expr.constant;
+  for (auto &term : constraint.expr.terms) {
+    if (term.first == NIL) continue;
+    row.expr.terms.push_back(term);
+    (term.second < 0 ? min_activity : max_activity) += term.second;
+  }
+  if ((row.sense == kLessEqual && max_activity <= row.rhs) ||
+      (row.sense == kGreaterEqual && min_activity >= row.rhs) ||
+      (row.sense == kEqual && min_activity == row.rhs &&
+       max_activity == row.rhs)) {
+    ++redundant_count_;
+    return;
+  }
+  Row linear_row = {NIL, 0, row};
+  rows_.push_back(linear_row);
+}
+
+void VNEProtectionSolver::ModelRows::AddIndicatorConstraint(
+    int variable, int value, const LinearConstraint &constraint) {
+  // A removed variable is fixed to 0.
+  if (variable == NIL) {
+    if (value == 0) AddConstraint(constraint);
+    return;
+  }
+  Row row = {variable, value, constraint};
+  auto &terms = row.constraint.expr.terms;
+  terms.erase(std::remove_if(terms.begin(), terms.end(),
+                             [](const std::pair<int, double> &term) {
+                               return term.first == NIL;
+                             }),
+              terms.end());
+  if (terms.empty() && row.constraint.sense == kLessEqual &&
+      row.constraint.expr.constant <= row.constraint.rhs) {
+    ++redundant_count_;
+    return;
+  }
+  rows_.push_back(row);
+}
+
+void VNEProtectionSolver::AddConstraint(const LinearConstraint &constraint) {
+  ModelRows rows;
+  rows.AddConstraint(constraint);
+  AddRows(rows);
+}
+
+void VNEProtectionSolver::AddIndicatorConstraint(
+    int variable, int value, const LinearConstraint &constraint) {
+  ModelRows rows;
+  rows.AddIndicatorConstraint(variable, value, constraint);
+  AddRows(rows);
+}
+
+void VNEProtectionSolver::AddRows(const ModelRows &rows, bool is_lazy) {
+  for (auto &row : rows.rows_) {
+    if (row.variable == NIL && is_lazy) {
+      backend_->AddLazyConstraint(row.constraint);
+    } else if (row.variable == NIL) {
+      backend_->AddConstraint(row.constraint);
+    } else {
+      backend_->AddIndicatorConstraint(row.variable, row.value,
+                                       row.constraint);
+    }
+  }
+  redundant_constraint_count_ += rows.redundant_count_;
+}
+
+void VNEProtectionSolver::BuildModel(int threads) {
+  // Location constraints of virtual nodes are enforced by Presolve(), which
+  // creates node mapping variables for the allowed locations only.
+
+  // Constraint: Capacity constraint of physical links. A model kept across
+  // virtual networks has them already, and a batch adds them for all its
+  // virtual networks.
+  if (!capacity_row_.empty()) {
+    for (int u = 0; u < pn_.node_count(); ++u) {
+      for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+        if (u > pn_.head(uv)) continue;
+        LinearExpr sum;
+        LinearExpr sum_shadow;
+        AddLinkLoad(uv, &sum, &sum_shadow);
+        for (int shadow = 0; shadow < 2; ++shadow) {
+          for (auto &term : (shadow ? sum_shadow : sum).terms) {
+            if (term.first == NIL) continue;
+            backend_->SetCoefficient(capacity_row_[uv] + shadow, term.first,
+                                     term.second);
+          }
+        }
+      }
+    }
+  }
+
+  // Every family of constraints is split into parts of consecutive units,
+  // which are generated independently and added in order.
+  struct Family {
+    RowGenerator generator;
+    int units;
+    bool is_lazy;
+  };
+  std::vector<Family> families;
+  if (capacity_row_.empty() && admit_variable_ == NIL) {
+    families.push_back(Family{&VNEProtectionSolver::AddCapacityConstraints,
+                              pn_.node_count(), false});
+  }
+  families.push_back(Family{&VNEProtectionSolver::AddLinkMappingConstraints,
+                            vn_edge_count_, false});
+  families.push_back(Family{&VNEProtectionSolver::AddNodeMappingConstraints,
+                            virt_topology_->node_count(), false});
+  families.push_back(Family{&VNEProtectionSolver::AddNodeExclusionConstraints,
+                            pn_.node_count(), false});
+  families.push_back(Family{&VNEProtectionSolver::AddFlowConstraints,
+                            vn_edge_count_ * pn_.node_count(), false});
+  if (formulation_ == kIndicatorFormulation) {
+    families.push_back(
+        Family{&VNEProtectionSolver::AddIndicatorEdgeDisjointness,
+               pn_edge_count_, lazy_disjointness_});
+    families.push_back(
+        Family{&VNEProtectionSolver::AddIndicatorNodeDisjointness,
+               pn_.node_count(), lazy_disjointness_});
+  } else {
+    families.push_back(Family{&VNEProtectionSolver::AddLinearEdgeDisjointness,
+                              pn_edge_count_, lazy_disjointness_});
+    families.push_back(Family{&VNEProtectionSolver::AddLinearNodeDisjointness,
+                              pn_.node_count(), lazy_disjointness_});
+  }
+  // Small parts balance the load of the threads, and at most
+  // kPartsAheadPerThread parts per thread wait to be added, which bounds the
+  // memory of the rows.
+  const int kPartsPerThread = 16;
+  const int kPartsAheadPerThread = 2;
+  struct Part {
+    RowGenerator generator;
+    int first, last;
+    bool is_lazy;
+  };
+  std::vector<Part> parts;
+  for (auto &family : families) {
+    int parts_per_family = kPartsPerThread * std::max(1, threads);
+    int part_size = std::max(
+        1, (family.units + parts_per_family - 1) / parts_per_family);
+    for (int first = 0; first < family.units; first += part_size) {
+      Part part = {family.generator, first,
+                   std::min(family.units, first + part_size), family.is_lazy};
+      parts.push_back(part);
+    }
+  }
+  std::vector<ModelRows> part_rows(parts.size());
+  RunInOrder(parts.size(), threads, kPartsAheadPerThread * threads,
+             [this, &parts, &part_rows](int i) {
+               (this->*parts[i].generator)(parts[i].first, parts[i].last,
+                                           &part_rows[i]);
+             },
+             [this, &parts, &part_rows](int i) {
+               AddRows(part_rows[i], parts[i].is_lazy);
+               part_rows[i] = ModelRows();
+             });
+  symmetry_anchor_ = NIL;
+  if (symmetry_breaking_) AddSymmetryBreakingConstraints();
+
+  // Objective function.
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    auto &m_neighbors = virt_topology_->adj_list()->at(m);
+    for (int j = 0; j < m_neighbors.size(); ++j) {
+      int n = m_neighbors[j].node_id;
+      if (m < n) continue;
+      int mn = vn_edge_offset_[m] + j;
+      long beta_mn = m_neighbors[j].bandwidth;
+      for (int u = 0; u < pn_.node_count(); ++u) {
+        for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+          int cost_uv = pn_.cost(uv);
+          DEBUG("u = %d, v = %d, m = %d, n = %d\n", u, pn_.head(uv), m, n);
+          DEBUG("u = %d, v = %d, m + offset = %d, n + offset = %d\n", u,
+                pn_.head(uv), m + virt_topology_->node_count(),
+                n + virt_topology_->node_count());
+          objective_.AddTerm(x(mn, uv), cost_uv * beta_mn);
+          objective_.AddTerm(x(mn + vn_edge_count_, uv), cost_uv * beta_mn);
+        }
+      }
+    }
+  }
+  // The objective only takes integer values, so objective > 0 is written as
+  // objective >= 1.
+  objective_.terms.erase(
+      std::remove_if(objective_.terms.begin(), objective_.terms.end(),
+                     [](const std::pair<int, double> &term) {
+                       return term.first == NIL;
+                     }),
+      objective_.terms.end());
+  AddConstraint(Demand(objective_, kGreaterEqual));
+  if (admit_variable_ == NIL) backend_->SetObjective(objective_);
+}
+
+
+// Constraint: Capacity constraint of physical links. Bandwidth reserved by
+// earlier embeddings is not available. Links are undirected, so there is one
+// constraint per link, generated at its end with the smaller id.
+void VNEProtectionSolver::AddCapacityConstraints(int first, int last,
+                                                 ModelRows *rows) const {
+  for (int u = first; u < last; ++u) {
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      if (u > pn_.head(uv)) continue;
+      long beta_uv = pn_.residual_bandwidth(uv);
+      LinearExpr sum;
+      LinearExpr sum_shadow;
+      AddLinkLoad(uv, &sum, &sum_shadow);
+      rows->AddConstraint(Constraint(sum, kLessEqual, beta_uv));
+      rows->AddConstraint(Constraint(sum_shadow, kLessEqual, beta_uv));
+    }
+  }
+}
+
+// Constraint: Every virtual link is mapped to one or more physical links.
+// A virtual link cannot use both directions of a physical link.
+void VNEProtectionSolver::AddLinkMappingConstraints(int first, int last,
+                                                    ModelRows *rows) const {
+  for (int mn = first; mn < last; ++mn) {
+    int shadow_mn = mn + vn_edge_count_;
+    LinearExpr sum;
+    LinearExpr sum_shadow;
+    for (int uv = 0; uv < pn_edge_count_; ++uv) {
+      int vu = pn_.reverse(uv);
+      if (formulation_ == kIndicatorFormulation) {
+        rows->AddIndicatorConstraint(
+            x(mn, uv), 1, Constraint(Var(x(mn, vu)), kLessEqual, 0));
+        rows->AddIndicatorConstraint(
+            x(shadow_mn, uv), 1,
+            Constraint(Var(x(shadow_mn, vu)), kLessEqual, 0));
+      } else if (uv < vu) {
+        LinearExpr both_directions = Var(x(mn, uv));
+        both_directions.AddTerm(x(mn, vu), 1);
+        rows->AddConstraint(Constraint(both_directions, kLessEqual, 1));
+        LinearExpr shadow_both_directions = Var(x(shadow_mn, uv));
+        shadow_both_directions.AddTerm(x(shadow_mn, vu), 1);
+        rows->AddConstraint(
+            Constraint(shadow_both_directions, kLessEqual, 1));
+      }
+      sum.AddTerm(x(mn, uv), 1);
+      sum_shadow.AddTerm(x(shadow_mn, uv), 1);
+    }
+    rows->AddConstraint(Demand(sum, kGreaterEqual));
+    rows->AddConstraint(Demand(sum_shadow, kGreaterEqual));
+  }
+}
+
+// Constraint: Every virtual node is mapped to exactly one physical node.
+void VNEProtectionSolver::AddNodeMappingConstraints(int first, int last,
+                                                    ModelRows *rows) const {
+  // node_id offset for the shadow virtual topology.
+  int offset = virt_topology_->node_count();
+  for (int m = first; m < last; ++m) {
+    LinearExpr sum;
+    LinearExpr sum_shadow;
+    for (int u = 0; u < physical_topology_->node_count(); ++u) {
+      DEBUG("u = %d, m = %d,\n", u, m);
+      DEBUG("u = %d, m + offset = %d\n", u, m + offset);
+      sum.AddTerm(y_m_u(m, u), 1);
+      sum_shadow.AddTerm(y_m_u(m + offset, u), 1);
+    }
+    rows->AddConstraint(Demand(sum, kEqual));
+    rows->AddConstraint(Demand(sum_shadow, kEqual));
+  }
+}
+
+// Constraint: No two virtual nodes are mapped to the same physical node.
+void VNEProtectionSolver::AddNodeExclusionConstraints(int first, int last,
+                                                      ModelRows *rows) const {
+  int offset = virt_topology_->node_count();
+  for (int u = first; u < last; ++u) {
+    LinearExpr sum;
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      DEBUG("u = %d, m = %d,\n", u, m);
+      DEBUG("u = %d, m + offset = %d\n", u, m + offset);
+      sum.AddTerm(y_m_u(m, u), 1);
+      sum.AddTerm(y_m_u(m + offset, u), 1);
+    }
+    rows->AddConstraint(Constraint(sum, kLessEqual, 1));
+  }
+}
+
+// Constraint: Flow constraint to ensure path connectivity. Unit i is virtual
+// edge i / pn_.node_count() at physical node i % pn_.node_count().
+void VNEProtectionSolver::AddFlowConstraints(int first, int last,
+                                             ModelRows *rows) const {
+  int offset = virt_topology_->node_count();
+  for (int i = first; i < last; ++i) {
+    int mn = i / pn_.node_count();
+    int u = i % pn_.node_count();
+    int m = std::upper_bound(vn_edge_offset_.begin(), vn_edge_offset_.end(),
+                             mn) -
+            vn_edge_offset_.begin() - 1;
+    int n = virt_topology_->adj_list()->at(m)[mn - vn_edge_offset_[m]].node_id;
+    int shadow_mn = mn + vn_edge_count_;
+    // sum(x_mn_uv - x_mn_vu) == y_m_u - y_n_u.
+    LinearExpr sum;
+    LinearExpr sum_shadow;
+    for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+      int vu = pn_.reverse(uv);
+      sum.AddTerm(x(mn, uv), 1);
+      sum.AddTerm(x(mn, vu), -1);
+      sum_shadow.AddTerm(x(shadow_mn, uv), 1);
+      sum_shadow.AddTerm(x(shadow_mn, vu), -1);
+    }
+    sum.AddTerm(y_m_u(m, u), -1);
+    sum.AddTerm(y_m_u(n, u), 1);
+    sum_shadow.AddTerm(y_m_u(m + offset, u), -1);
+    sum_shadow.AddTerm(y_m_u(n + offset, u), 1);
+    rows->AddConstraint(Constraint(sum, kEqual, 0));
+    rows->AddConstraint(Constraint(sum_shadow, kEqual, 0));
+  }
+}
+
+LinearConstraint VNEProtectionSolver::Demand(LinearExpr sum,
+                                             ConstraintSense sense) const {
+  if (admit_variable_ == NIL) return Constraint(sum, sense, 1);
+  sum.AddTerm(admit_variable_, -1);
+  return Constraint(sum, sense, 0);
+}
+
+void VNEProtectionSolver::AddLinkLoad(int uv, LinearExpr *sum,
+                                      LinearExpr *shadow_sum) const {
+  // Every virtual link is counted once, through the flow of its (m, n)
+  // direction with m > n in either direction of the link.
+  int vu = pn_.reverse(uv);
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    auto &m_neighbors = virt_topology_->adj_list()->at(m);
+    for (int j = 0; j < m_neighbors.size(); ++j) {
+      int n = m_neighbors[j].node_id;
+      if (m < n) continue;
+      int mn = vn_edge_offset_[m] + j;
+      long beta_mn = m_neighbors[j].bandwidth;
+      DEBUG("uv = %d, m = %d, n = %d\n", uv, m, n);
+      sum->AddTerm(x(mn, uv), beta_mn);
+      sum->AddTerm(x(mn, vu), beta_mn);
+      shadow_sum->AddTerm(x(mn + vn_edge_count_, uv), beta_mn);
+      shadow_sum->AddTerm(x(mn + vn_edge_count_, vu), beta_mn);
+    }
+  }
+}
+
+// Mutual exclusion constraints.
+// Constraint: A virtual link and its shadow virtual link cannot share the
+// same physical link. All variables are non-negative, so "sum == 0" is
+// written as "sum <= 0".
+void VNEProtectionSolver::AddIndicatorEdgeDisjointness(
+    int first, int last, ModelRows *rows) const {
+  for (int uv = first; uv < last; ++uv) {
+    LinearExpr sum;
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      auto &m_neighbors = virt_topology_->adj_list()->at(m);
+      for (int j = 0; j < m_neighbors.size(); ++j) {
+        int n = m_neighbors[j].node_id;
+        if (m < n) continue;
+        sum.AddTerm(x(vn_edge_offset_[m] + j + vn_edge_count_, uv), 1);
+      }
+    }
+    for (int mn = 0; mn < vn_edge_count_; ++mn) {
+      rows->AddIndicatorConstraint(x(mn, uv), 1,
+                                   Constraint(sum, kLessEqual, 0));
+    }
+  }
+}
+
+// Constraint: No two physical paths having a common physical node be shared
+// between a virtual link and any link from the shadow network. Shadow node
+// mapping should also exclude the nodes used for mapping links of the working
+// virtual network and vice versa. w_u is forced to 1 if u carries working
+// flow and then excludes shadow flow and shadow nodes from u.
+void VNEProtectionSolver::AddIndicatorNodeDisjointness(
+    int first, int last, ModelRows *rows) const {
+  // node_id offset for the shadow virtual topology.
+  int offset = virt_topology_->node_count();
+  for (int u = first; u < last; ++u) {
+    LinearExpr sum;
+    LinearExpr shadow_node_map_sum;
+    LinearExpr shadow_sum;
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      shadow_node_map_sum.AddTerm(y_m_u(m + offset, u), 1);
+    }
+    for (int mn = 0; mn < vn_edge_count_; ++mn) {
+      for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+        sum.AddTerm(x(mn, uv), 1);
+        shadow_sum.AddTerm(x(mn + vn_edge_count_, uv), 1);
+      }
+    }
+    int w = w_u_ + u;
+    rows->AddIndicatorConstraint(w, 0, Constraint(sum, kLessEqual, 0));
+    rows->AddIndicatorConstraint(w, 1,
+                                 Constraint(shadow_sum, kLessEqual, 0));
+    rows->AddIndicatorConstraint(
+        w, 1, Constraint(shadow_node_map_sum, kLessEqual, 0));
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      rows->AddIndicatorConstraint(y_m_u(m, u), 1,
+                                   Constraint(shadow_sum, kLessEqual, 0));
+    }
+  }
+}
+
+// Mutual exclusion constraints.
+// Constraint: A virtual link and its shadow virtual link cannot share the
+// same physical link. z_uv is 1 if uv carries working flow, which excludes
+// shadow flow from uv.
+void VNEProtectionSolver::AddLinearEdgeDisjointness(int first, int last,
+                                                    ModelRows *rows) const {
+  bool aggregated = formulation_ == kAggregatedFormulation;
+  // Number of shadow virtual links counted per physical edge, i.e., those
+  // with m > n.
+  int shadow_link_count = vn_edge_count_ / 2;
+  for (int uv = first; uv < last; ++uv) {
+    int z = z_uv_ + uv;
+    LinearExpr sum;
+    LinearExpr shadow_sum;
+    for (int mn = 0; mn < vn_edge_count_; ++mn) {
+      if (aggregated) {
+        sum.AddTerm(x(mn, uv), 1);
+      } else {
+        LinearExpr link;
+        link.AddTerm(x(mn, uv), 1);
+        link.AddTerm(z, -1);
+        rows->AddConstraint(Constraint(link, kLessEqual, 0));
+      }
+    }
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      auto &m_neighbors = virt_topology_->adj_list()->at(m);
+      for (int j = 0; j < m_neighbors.size(); ++j) {
+        int n = m_neighbors[j].node_id;
+        if (m < n) continue;
+        int shadow_mn = vn_edge_offset_[m] + j + vn_edge_count_;
+        if (aggregated) {
+          shadow_sum.AddTerm(x(shadow_mn, uv), 1);
+        } else {
+          LinearExpr link;
+          link.AddTerm(x(shadow_mn, uv), 1);
+          link.AddTerm(z, 1);
+          rows->AddConstraint(Constraint(link, kLessEqual, 1));
+        }
+      }
+    }
+    if (aggregated) {
+      sum.AddTerm(z, -vn_edge_count_);
+      rows->AddConstraint(Constraint(sum, kLessEqual, 0));
+      shadow_sum.AddTerm(z, shadow_link_count);
+      rows->AddConstraint(
+          Constraint(shadow_sum, kLessEqual, shadow_link_count));
+    }
+  }
+}
+
+// Constraint: No two physical paths having a common physical node be shared
+// between a virtual link and any link from the shadow network, and shadow
+// nodes are not mapped to nodes used by the working network. w_u is 1 if u
+// carries working flow or hosts a working node, which excludes shadow flow
+// and shadow nodes from u.
+void VNEProtectionSolver::AddLinearNodeDisjointness(int first, int last,
+                                                    ModelRows *rows) const {
+  int offset = virt_topology_->node_count();
+  bool aggregated = formulation_ == kAggregatedFormulation;
+  for (int u = first; u < last; ++u) {
+    int w = w_u_ + u;
+    // Upper bounds of the working and shadow sums for the big-M
+    // coefficients.
+    int max_flow = vn_edge_count_ * pn_.degree(u);
+    int max_shadow = max_flow + virt_topology_->node_count();
+    LinearExpr sum;
+    LinearExpr shadow_sum;
+    LinearExpr node_map_sum;
+    for (int m = 0; m < virt_topology_->node_count(); ++m) {
+      node_map_sum.AddTerm(y_m_u(m, u), 1);
+      if (aggregated) {
+        shadow_sum.AddTerm(y_m_u(m + offset, u), 1);
+      } else {
+        LinearExpr link;
+        link.AddTerm(y_m_u(m + offset, u), 1);
+        link.AddTerm(w, 1);
+        rows->AddConstraint(Constraint(link, kLessEqual, 1));
+      }
+    }
+    node_map_sum.AddTerm(w, -1);
+    rows->AddConstraint(Constraint(node_map_sum, kLessEqual, 0));
+    for (int mn = 0; mn < vn_edge_count_; ++mn) {
+      for (int uv = pn_.begin(u); uv < pn_.end(u); ++uv) {
+        if (aggregated) {
+          sum.AddTerm(x(mn, uv), 1);
+          shadow_sum.AddTerm(x(mn + vn_edge_count_, uv), 1);
+          continue;
+        }
+        LinearExpr link;
+        link.AddTerm(x(mn, uv), 1);
+        link.AddTerm(w, -1);
+        rows->AddConstraint(Constraint(link, kLessEqual, 0));
+        LinearExpr shadow_link;
+        shadow_link.AddTerm(x(mn + vn_edge_count_, uv), 1);
+        shadow_link.AddTerm(w, 1);
+        rows->AddConstraint(Constraint(shadow_link, kLessEqual, 1));
+      }
+    }
+    if (aggregated) {
+      sum.AddTerm(w, -max_flow);
+      rows->AddConstraint(Constraint(sum, kLessEqual, 0));
+      shadow_sum.AddTerm(w, max_shadow);
+      rows->AddConstraint(Constraint(shadow_sum, kLessEqual, max_shadow));
+    }
+  }
+}
+
+// Constraint: The working copy of the anchor is mapped to a physical node with
+// a lower id than its shadow copy. Node exclusion keeps the two apart, so
+// either a solution or the one with the working and the shadow network
+// exchanged satisfies it.
+void VNEProtectionSolver::AddSymmetryBreakingConstraints() {
+  int offset = virt_topology_->node_count();
+  int anchor_locations = 0;
+  for (int m = 0; m < offset; ++m) {
+    int locations = 0;
+    for (int u = 0; u < pn_.node_count(); ++u) {
+      if (y_m_u(m, u) != NIL) ++locations;
+    }
+    if (locations >= 2 &&
+        (symmetry_anchor_ == NIL || locations < anchor_locations)) {
+      symmetry_anchor_ = m;
+      anchor_locations = locations;
+    }
+  }
+  if (symmetry_anchor_ == NIL) return;
+  LinearExpr sum;
+  for (int v = 0; v < pn_.node_count(); ++v) {
+    if (y_m_u(symmetry_anchor_, v) == NIL) continue;
+    sum.AddTerm(y_m_u(symmetry_anchor_ + offset, v), 1);
+    AddConstraint(Constraint(sum, kLessEqual, 0));
+    sum.AddTerm(y_m_u(symmetry_anchor_, v), -1);
+  }
+}
+
+bool VNEProtectionSolver::GetStartVariables(const VNEmbedding &embedding,
+                                            std::vector<int> *ones) const {
+  int anchor = symmetry_anchor_;
+  if (anchor != NIL &&
+      embedding.node_map[anchor] > embedding.shadow_node_map[anchor]) {
+    // The same embedding with the networks exchanged satisfies the symmetry
+    // breaking constraints.
+    VNEmbedding mirror = embedding;
+    std::swap(mirror.node_map, mirror.shadow_node_map);
+    std::swap(mirror.edge_map, mirror.shadow_edge_map);
+    return GetStartVariables(mirror, ones);
+  }
+  // A mapping removed by Presolve() cannot be part of a feasible solution.
+  bool is_feasible = true;
+  auto set = [&](int variable) {
+    if (variable == NIL) {
+      is_feasible = false;
+      return;
+    }
+    ones->push_back(variable);
+  };
+  int offset = virt_topology_->node_count();
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    set(y_m_u(m, embedding.node_map[m]));
+    set(y_m_u(m + offset, embedding.shadow_node_map[m]));
+  }
+  // Paths are stored for m > n from the host of m to the host of n; flow of
+  // (n, m) takes the reverse path.
+  for (auto &entry : embedding.edge_map) {
+    int m = entry.first.first, n = entry.first.second;
+    int mn = VirtualEdgeId(m, n), nm = VirtualEdgeId(n, m);
+    for (auto &link : entry.second) {
+      int u = link.first, v = link.second;
+      set(x(mn, PhysicalEdgeId(u, v)));
+      set(x(nm, PhysicalEdgeId(v, u)));
+      set(w_u_ + u);
+      set(w_u_ + v);
+      if (z_uv_ >= 0) {
+        set(z_uv_ + PhysicalEdgeId(u, v));
+        set(z_uv_ + PhysicalEdgeId(v, u));
+      }
+    }
+    for (auto &link : embedding.shadow_edge_map.at(entry.first)) {
+      int u = link.first, v = link.second;
+      set(x(mn + vn_edge_count_, PhysicalEdgeId(u, v)));
+      set(x(nm + vn_edge_count_, PhysicalEdgeId(v, u)));
+    }
+  }
+  if (admit_variable_ != NIL) set(admit_variable_);
+  if (!is_feasible) {
+    DEBUG("MIP start uses mappings removed by presolve\n");
+  }
+  return is_feasible;
+}
+
+void VNEProtectionSolver::SetMIPStart(const VNEmbedding &embedding) {
+  std::vector<int> ones;
+  if (!GetStartVariables(embedding, &ones)) return;
+  std::vector<double> values(backend_->num_variables() - first_variable_, 0.0);
+  for (int variable : ones) values[variable - first_variable_] = 1.0;
+  std::vector<std::pair<int, double> > start;
+  for (int i = 0; i < values.size(); ++i) {
+    start.push_back(std::make_pair(first_variable_ + i, values[i]));
+  }
+  backend_->SetMIPStart(start);
+  backend_->SetCutoff(embedding.cost);
+}
+
+bool VNEProtectionSolver::Solve() {
+  return backend_->Solve();
+}
+
+int VNEProtectionSolver::PhysicalEdgeId(int u, int v) const {
+  return pn_.edge_id(u, v);
+}
+
+int VNEProtectionSolver::VirtualEdgeId(int m, int n) const {
+  int offset = virt_topology_->node_count();
+  int shadow_edge_offset = 0;
+  if (m >= offset) {
+    m -= offset;
+    n -= offset;
+    shadow_edge_offset = vn_edge_count_;
+  }
+  auto &m_neighbors = virt_topology_->adj_list()->at(m);
+  for (int j = 0; j < m_neighbors.size(); ++j) {
+    if (m_neighbors[j].node_id == n)
+      return vn_edge_offset_[m] + j + shadow_edge_offset;
+  }
+  return NIL;
+}
+
+VNEProtectionBatchSolver::VNEProtectionBatchSolver(
+    MIPBackend *backend, Graph *physical_topology,
+    const std::vector<Graph *> &virt_topologies,
+    const std::vector<std::vector<std::vector<int>> *> &location_constraints,
+    Formulation formulation)
+    : backend_(backend), physical_topology_(physical_topology) {
+  for (int i = 0; i < virt_topologies.size(); ++i) {
+    // Decide on admission before on the node mapping.
+    int admit = backend_->AddVariable(0, 1, kBinary);
+    backend_->SetPriority(admit, 2);
+    solvers_.emplace_back(new VNEProtectionSolver(
+        backend_, physical_topology_, virt_topologies[i], virt_topologies[i],
+        location_constraints[i], formulation, admit));
+  }
+}
+
+void VNEProtectionBatchSolver::set_lazy_disjointness(bool lazy_disjointness) {
+  for (auto &solver : solvers_) {
+    solver->set_lazy_disjointness(lazy_disjointness);
+  }
+}
+
+void VNEProtectionBatchSolver::set_symmetry_breaking(bool symmetry_breaking) {
+  for (auto &solver : solvers_) {
+    solver->set_symmetry_breaking(symmetry_breaking);
+  }
+}
+
+void VNEProtectionBatchSolver::BuildModel(int threads) {
+  if (solvers_.empty()) return;
+  for (auto &solver : solvers_) solver->BuildModel(threads);
+
+  // Constraint: Capacity constraint of physical links, shared by the working
+  // and the shadow networks of all virtual networks, which are reserved
+  // together once they are embedded. The edge ids of all models are those
+  // of the same physical topology.
+  VNEProtectionSolver *first = solvers_.front().get();
+  auto &pn = first->physical_graph();
+  for (int u = 0; u < pn.node_count(); ++u) {
+    for (int uv = pn.begin(u); uv < pn.end(u); ++uv) {
+      if (u > pn.head(uv)) continue;
+      LinearExpr sum;
+      for (auto &solver : solvers_) solver->AddLinkLoad(uv, &sum, &sum);
+      first->AddConstraint(
+          Constraint(sum, kLessEqual, pn.residual_bandwidth(uv)));
+    }
+  }
+
+  // Objective function: the total cost of the embedded virtual networks plus
+  // a penalty for every rejected one that exceeds its largest possible cost.
+  LinearExpr objective;
+  penalties_.clear();
+  for (auto &solver : solvers_) {
+    double penalty = 1;
+    for (auto &term : solver->objective().terms) {
+      if (term.second > 0) penalty += term.second;
+    }
+    penalties_.push_back(penalty);
+    objective.Add(solver->objective(), 1);
+    objective.AddTerm(solver->admit_variable(), -penalty);
+    objective.constant += penalty;
+  }
+  backend_->SetObjective(objective);
+}
+
+void VNEProtectionBatchSolver::SetMIPStart(
+    const std::vector<VNEmbedding> &embeddings) {
+  std::vector<double> values(backend_->num_variables(), 0.0);
+  double cost = 0.0;
+  for (int i = 0; i < request_count(); ++i) {
+    std::vector<int> ones;
+    if (embeddings[i].node_map.empty() ||
+        !solvers_[i]->GetStartVariables(embeddings[i], &ones)) {
+      cost += penalties_[i];
+      continue;
+    }
+    for (int variable : ones) values[variable] = 1.0;
+    cost += embeddings[i].cost;
+  }
+  std::vector<std::pair<int, double> > start;
+  for (int variable = 0; variable < values.size(); ++variable) {
+    start.push_back(std::make_pair(variable, values[variable]));
+  }
+  backend_->SetMIPStart(start);
+  backend_->SetCutoff(cost);
+}
+
+bool VNEProtectionBatchSolver::Solve() {
+  return backend_->Solve();
+}
@@ -0,0 +1,314 @@
+#ifndef VNE_PROTECTION_SOLVER_H_
+#define VNE_PROTECTION_SOLVER_H_
+
+#include "datastructure.h"
+#include "mip_backend.h"
+#include "util.h"
+
+// How the disjointness rules between the working and the shadow network are
+// expressed in the model:
+//   kIndicatorFormulation: indicator constraints on the mapping variables.
+//   kAggregatedFormulation: binary "used by working flow" variables per
+//     physical edge and node, linked to the mapping variables by one big-M
+//     constraint per edge or node and network.
+//   kDisaggregatedFormulation: the same variables linked by one constraint
+//     per mapping variable, which gives the tightest LP relaxation.
+enum Formulation {
+  kIndicatorFormulation,
+  kAggregatedFormulation,
+  kDisaggregatedFormulation
+};
+
+// Parses "indicator", "aggregated" or "disaggregated". Returns false for any
+// other name.
+bool ParseFormulation(const std::string &name, Formulation *formulation);
+
+// Returns the name that ParseFormulation parses into formulation.
+const char *FormulationName(Formulation formulation);
+
+// Builds the ILP model for embedding a virtual network with 1 + 1 protection
+// and solves it with a MIPBackend.
+class VNEProtectionSolver {
+ public:
+  // If admit_variable is not NIL, the virtual network is one of several that
+  // VNEProtectionBatchSolver embeds jointly into the same backend: it is only
+  // embedded if the binary admit_variable is 1, and BuildModel() leaves the
+  // capacity constraints and the objective to the batch solver.
+  VNEProtectionSolver(MIPBackend *backend, Graph *physical_topology,
+                      Graph *virt_topology, Graph *shadow_virt_topology,
+                      std::vector<std::vector<int>> *location_constraint,
+                      Formulation formulation = kIndicatorFormulation,
+                      int admit_variable = NIL);
+  // Builds the part of the model that only depends on the physical topology,
+  // i.e., the capacity constraints, and keeps it in backend for a sequence of
+  // virtual networks.
+  // SetVirtualNetwork() must be called before every BuildModel().
+  VNEProtectionSolver(MIPBackend *backend, Graph *physical_topology,
+                      Formulation formulation);
+
+  // Replaces the virtual network of a model built by the constructor above:
+  // removes the variables and constraints of the previous one from the
+  // backend and sets the capacity constraints to the current residual
+  // bandwidth of the physical topology, which must not have changed
+  // otherwise.
+  void SetVirtualNetwork(Graph *virt_topology, Graph *shadow_virt_topology,
+                         std::vector<std::vector<int>> *location_constraint);
+
+  MIPBackend *backend() { return backend_; }
+  // Compact copy of the physical topology, which defines the physical edge
+  // ids.
+  const CompactGraph &physical_graph() const { return pn_; }
+  int pn_edge_count() const { return pn_edge_count_; }
+  int vn_edge_count() const { return vn_edge_count_; }
+  // Number of edge and node mapping variables in the model, and of those
+  // removed by Presolve().
+  int x_mn_uv_count() const { return x_count_; }
+  int y_m_u_count() const { return y_count_; }
+  int removed_x_mn_uv_count() const { return x_.size() - x_count_; }
+  int removed_y_m_u_count() const { return y_.size() - y_count_; }
+  // Number of constraints left out because they hold for every assignment of
+  // the remaining variables.
+  int redundant_constraint_count() const {
+    return redundant_constraint_count_;
+  }
+  int admit_variable() const { return admit_variable_; }
+  // Cost of the embedding in terms of the model variables; set by
+  // BuildModel().
+  const LinearExpr &objective() const { return objective_; }
+
+  // Returns the edge mapping variable of virtual edge (m, n) and physical edge
+  // (u, v), or NIL if Presolve() has removed the mapping. Virtual nodes of the
+  // shadow network are numbered from virt_topology->node_count() onwards.
+  // (m, n) and (u, v) must be edges of the respective topologies.
+  int x_mn_uv(int m, int n, int u, int v) const {
+    return x(VirtualEdgeId(m, n), PhysicalEdgeId(u, v));
+  }
+
+  // Returns the edge mapping variable of the directed virtual edge with id
+  // vedge_id and the directed physical edge with id pedge_id, or NIL.
+  int x(int vedge_id, int pedge_id) const {
+    return x_[vedge_id * pn_edge_count_ + pedge_id];
+  }
+
+  // Returns the node mapping variable of virtual node m and physical node u,
+  // or NIL.
+  int y_m_u(int m, int u) const {
+    return y_[m * physical_topology_->node_count() + u];
+  }
+
+  // If set, BuildModel() passes the disjointness constraints to the backend
+  // as lazy constraints, so they only enter the model once a candidate
+  // solution violates them. Only the linear formulations have linear
+  // disjointness constraints; indicator constraints are always added to the
+  // model.
+  void set_lazy_disjointness(bool lazy_disjointness) {
+    lazy_disjointness_ = lazy_disjointness;
+  }
+
+  // Exchanging the working and the shadow network maps every solution to one
+  // of the same cost, so the search would explore every solution twice. If
+  // set, BuildModel() adds constraints that keep only one of the two: the
+  // working copy of an anchor virtual node is mapped to a physical node with
+  // a lower id than its shadow copy. SetMIPStart() exchanges the networks of
+  // a start that violates them.
+  void set_symmetry_breaking(bool symmetry_breaking) {
+    symmetry_breaking_ = symmetry_breaking;
+  }
+  // The anchor virtual node, or NIL if there are no symmetry breaking
+  // constraints.
+  int symmetry_anchor() const { return symmetry_anchor_; }
+
+  // Generates the constraints on up to threads threads. They are added to the
+  // backend in the same order for any number of threads, so the model does
+  // not depend on it.
+  void BuildModel(int threads = 1);
+  // Passes embedding, e.g., one found by VNEProtectionHeuristicSolver, to the
+  // backend as a MIP start and its cost as the cutoff. Must be called after
+  // BuildModel().
+  void SetMIPStart(const VNEmbedding &embedding);
+  bool Solve();
+
+ private:
+  friend class VNEProtectionBatchSolver;
+
+  // Directed edge ids are assigned in adjacency list order, i.e., the i-th
+  // neighbor of u has id edge_offset[u] + i (pn_.begin(u) + i for physical
+  // edges). Virtual edges of the shadow network use the id of the working
+  // edge plus vn_edge_count_.
+  int PhysicalEdgeId(int u, int v) const;
+  int VirtualEdgeId(int m, int n) const;
+
+  // Removes the node mappings that violate the location constraints or lack
+  // bandwidth, and the edge mappings that cannot be part of a path between
+  // the remaining locations of the ends of a virtual link.
+  void Presolve();
+  // Adds the variables of the virtual network and then those of the
+  // physical network, in the same order for both constructors.
+  void AddVariables();
+  // Adds the edge and node mapping variables kept by Presolve(). Returns the
+  // id of the first node mapping variable.
+  int AddVirtualNetworkVariables();
+  // Adds the variables per physical node and edge, w_u_ and z_uv_.
+  void AddPhysicalVariables();
+
+  // Rows generated by one part of BuildModel(), kept in the order they are
+  // added to the backend. The terms of removed variables are dropped, and
+  // redundant rows are only counted.
+  class ModelRows {
+   public:
+    ModelRows() : redundant_count_(0) {}
+
+    void AddConstraint(const LinearConstraint &constraint);
+    void AddIndicatorConstraint(int variable, int value,
+                                const LinearConstraint &constraint);
+
+   private:
+    friend class VNEProtectionSolver;
+
+    // variable is NIL for a linear constraint.
+    struct Row {
+      int variable;
+      int value;
+      LinearConstraint constraint;
+    };
+    std::vector<Row> rows_;
+    int redundant_count_;
+  };
+  // Generates the rows of one family of constraints for the units, e.g., the
+  // physical nodes, first to last - 1 of the family.
+  typedef void (VNEProtectionSolver::*RowGenerator)(int first, int last,
+                                                    ModelRows *rows) const;
+
+  // Add a constraint to the backend after dropping the terms of removed
+  // variables, unless it is redundant.
+  void AddConstraint(const LinearConstraint &constraint);
+  void AddIndicatorConstraint(int variable, int value,
+                              const LinearConstraint &constraint);
+  // Linear rows go to the backend as lazy constraints if is_lazy is set.
+  void AddRows(const ModelRows &rows, bool is_lazy = false);
+  // Returns the constraint sum (>=, ==) 1, or sum (>=, ==) admit_variable_ if
+  // the virtual network may be rejected.
+  LinearConstraint Demand(LinearExpr sum, ConstraintSense sense) const;
+  // Appends the variables that are 1 in embedding to *ones. Returns false if
+  // embedding uses a mapping removed by Presolve().
+  bool GetStartVariables(const VNEmbedding &embedding,
+                         std::vector<int> *ones) const;
+  // Adds the bandwidth that the working and the shadow flow of every virtual
+  // link take on physical edge uv, in either direction, to *sum and
+  // *shadow_sum.
+  void AddLinkLoad(int uv, LinearExpr *sum, LinearExpr *shadow_sum) const;
+
+  // Families of constraints, see BuildModel(). Capacity, node exclusion and
+  // node disjointness constraints are generated per physical node, link
+  // mapping constraints per virtual edge, node mapping constraints per
+  // virtual node, flow constraints per pair of virtual edge and physical
+  // node, in this order, and edge disjointness constraints per physical edge.
+  void AddCapacityConstraints(int first, int last, ModelRows *rows) const;
+  void AddLinkMappingConstraints(int first, int last, ModelRows *rows) const;
+  void AddNodeMappingConstraints(int first, int last, ModelRows *rows) const;
+  void AddNodeExclusionConstraints(int first, int last,
+                                   ModelRows *rows) const;
+  void AddFlowConstraints(int first, int last, ModelRows *rows) const;
+  // Disjointness constraints of the respective formulations.
+  void AddIndicatorEdgeDisjointness(int first, int last,
+                                    ModelRows *rows) const;
+  void AddIndicatorNodeDisjointness(int first, int last,
+                                    ModelRows *rows) const;
+  void AddLinearEdgeDisjointness(int first, int last, ModelRows *rows) const;
+  void AddLinearNodeDisjointness(int first, int last, ModelRows *rows) const;
+  // Chooses the anchor among the virtual nodes with at least two locations,
+  // the one with the fewest, and adds the constraints
+  // sum(y_m'_u, u <= v) <= sum(y_m_u, u < v) for the anchor m, its shadow m'
+  // and every location v.
+  void AddSymmetryBreakingConstraints();
+
+  MIPBackend *backend_;
+  Graph *physical_topology_;
+  Graph *virt_topology_;
+  Graph *shadow_virt_topology_;
+  std::vector<std::vector<int>> *location_constraint_;
+  Formulation formulation_;
+  bool lazy_disjointness_;
+  bool symmetry_breaking_;
+  int symmetry_anchor_;
+  int admit_variable_;
+  CompactGraph pn_;
+
+  // Number of directed edges in the physical and the (working) virtual
+  // topology.
+  int pn_edge_count_;
+  int vn_edge_count_;
+  // Id of the first directed edge originating at each virtual node.
+  std::vector<int> vn_edge_offset_;
+
+  // Decision variables for edge mapping, for pairs of a directed virtual edge
+  // and a directed physical edge (see x()), and for node mapping (see
+  // y_m_u()). Mappings removed by Presolve() are NIL.
+  std::vector<int> x_;
+  std::vector<int> y_;
+  int x_count_;
+  int y_count_;
+  // Id of the first variable of the model.
+  int first_variable_;
+  int redundant_constraint_count_;
+  // Auxiliary binary variable per physical node, forced to 1 if the node
+  // carries flow of a working virtual link. It expresses the disjointness
+  // rules between the working and the shadow network.
+  int w_u_;
+  // Auxiliary binary variable per directed physical edge, forced to 1 if the
+  // edge carries flow of a working virtual link. Only the linear formulations
+  // use it; -1 otherwise.
+  int z_uv_;
+
+  // Id of the capacity constraint of the working network per directed
+  // physical edge in a model kept across virtual networks; that of the
+  // shadow network has the next id. Empty otherwise.
+  std::vector<int> capacity_row_;
+
+  // Variable indicating location constraint.
+  std::vector<std::vector<int>> l_m_u_;
+  // Objective function.
+  LinearExpr objective_;
+};
+
+// Embeds several virtual networks with 1 + 1 protection jointly, i.e., in one
+// model whose capacity constraints are shared by all of them. Every virtual
+// network has an admit variable and may be rejected. Rejecting one costs
+// more than any embedding of it, so the model embeds as many as fit and
+// minimizes the total cost of those.
+class VNEProtectionBatchSolver {
+ public:
+  VNEProtectionBatchSolver(
+      MIPBackend *backend, Graph *physical_topology,
+      const std::vector<Graph *> &virt_topologies,
+      const std::vector<std::vector<std::vector<int>> *> &location_constraints,
+      Formulation formulation = kIndicatorFormulation);
+
+  MIPBackend *backend() { return backend_; }
+  int request_count() const { return solvers_.size(); }
+  // Model of the i-th virtual network; its admit_variable() is 1 if it is
+  // embedded.
+  VNEProtectionSolver *request(int i) { return solvers_[i].get(); }
+
+  // See VNEProtectionSolver::set_lazy_disjointness(),
+  // set_symmetry_breaking() and BuildModel(). The capacity constraints are
+  // shared by the working and the shadow networks, so every virtual network
+  // keeps its own symmetry.
+  void set_lazy_disjointness(bool lazy_disjointness);
+  void set_symmetry_breaking(bool symmetry_breaking);
+  void BuildModel(int threads = 1);
+  // Passes embeddings, one per virtual network and found for all of them
+  // together, e.g., by VNEProtectionHeuristicSolver with bandwidth reserved
+  // in between, as a MIP start. Virtual networks without a node mapping are
+  // rejected. Must be called after BuildModel().
+  void SetMIPStart(const std::vector<VNEmbedding> &embeddings);
+  bool Solve();
+
+ private:
+  MIPBackend *backend_;
+  Graph *physical_topology_;
+  std::vector<std::unique_ptr<VNEProtectionSolver>> solvers_;
+  // Objective coefficient of rejecting each virtual network.
+  std::vector<double> penalties_;
+};
+#endif  // VNE_PROTECTION_SOLVER_H_
@@ -0,0 +1,189 @@
+#include "vne_server.h"
+#include "io.h"
+#include "util.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+const int kMaxRequestLength = 4096;
+
+void PrintLinks(const char *kind, const VNEmbedding::EdgeMap &edge_map,
+                FILE *out) {
+  for (auto &entry : edge_map) {
+    fprintf(out, "%s %d %d", kind, entry.first.first, entry.first.second);
+    for (auto &link : entry.second) {
+      fprintf(out, " %d,%d", link.first, link.second);
+    }
+    fprintf(out, "\n");
+  }
+}
+}  // namespace
+
+VNEServer::VNEServer(Graph *physical_topology,
+                     const EmbeddingOptions &options)
+    : physical_topology_(physical_topology),
+      options_(options),
+      embedder_(options, physical_topology) {}
+
+bool VNEServer::Serve(FILE *in, FILE *out) {
+  char line[kMaxRequestLength];
+  while (fgets(line, kMaxRequestLength, in)) {
+    char *command = strtok(line, " \t\r\n");
+    if (!command) continue;
+    std::vector<char *> args;
+    while (char *arg = strtok(NULL, " \t\r\n")) args.push_back(arg);
+    DEBUG("Request %s with %d arguments\n", command,
+          static_cast<int>(args.size()));
+    if (!strcmp(command, "quit")) {
+      fprintf(out, "OK\nEND\n");
+      fflush(out);
+      return false;
+    } else if (!strcmp(command, "embed") && args.size() == 3) {
+      Embed(args[0], args[1], args[2], out);
+    } else if (!strcmp(command, "release") && args.size() == 1) {
+      Release(args[0], out);
+    } else {
+      fprintf(out, "ERROR invalid request: %s\nEND\n", command);
+    }
+    // The client has left if the response cannot be written.
+    if (fflush(out) == EOF) return true;
+  }
+  return true;
+}
+
+bool VNEServer::ServeUnixSocket(const char *path) {
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", path);
+    return false;
+  }
+  strcpy(address.sun_path, path);
+  // Only a socket left behind by an earlier server is replaced.
+  struct stat status;
+  if (lstat(path, &status) == 0) {
+    if (!S_ISSOCK(status.st_mode)) {
+      fprintf(stderr, "%s exists and is not a socket\n", path);
+      return false;
+    }
+    unlink(path);
+  }
+  // A client that disconnects before reading its response must not kill the
+  // server and with it the reserved bandwidth; writes to it fail instead.
+  struct sigaction ignore;
+  memset(&ignore, 0, sizeof(ignore));
+  ignore.sa_handler = SIG_IGN;
+  sigaction(SIGPIPE, &ignore, NULL);
+  int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0 ||
+      bind(listen_fd, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) < 0 ||
+      listen(listen_fd, 1) < 0) {
+    perror("Cannot listen on socket");
+    if (listen_fd >= 0) close(listen_fd);
+    return false;
+  }
+  bool running = true, is_ok = true;
+  while (running) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      perror("Cannot accept client");
+      is_ok = false;
+      break;
+    }
+    int out_fd = dup(fd);
+    FILE *in = fdopen(fd, "r");
+    FILE *out = out_fd < 0 ? NULL : fdopen(out_fd, "w");
+    if (!in || !out) {
+      perror("Cannot open client connection");
+      if (in) {
+        fclose(in);
+      } else {
+        close(fd);
+      }
+      if (out) {
+        fclose(out);
+      } else if (out_fd >= 0) {
+        close(out_fd);
+      }
+      is_ok = false;
+      break;
+    }
+    running = Serve(in, out);
+    fclose(out);
+    fclose(in);
+  }
+  close(listen_fd);
+  unlink(path);
+  return is_ok;
+}
+
+void VNEServer::Embed(const std::string &id, const char *vn_topology_filename,
+                      const char *location_constraint_filename, FILE *out) {
+  if (tenants_.find(id) != tenants_.end()) {
+    fprintf(out, "ERROR %s is already embedded\nEND\n", id.c_str());
+    return;
+  }
+  if (access(vn_topology_filename, R_OK) ||
+      access(location_constraint_filename, R_OK)) {
+    fprintf(out, "ERROR cannot read %s or %s\nEND\n", vn_topology_filename,
+            location_constraint_filename);
+    return;
+  }
+  Tenant tenant;
+  tenant.virt_topology = InitializeTopologyFromFile(vn_topology_filename);
+  std::unique_ptr<std::vector<std::vector<int> > > location_constraint;
+  if (tenant.virt_topology) {
+    location_constraint = InitializeVNLocationsFromFile(
+        location_constraint_filename, tenant.virt_topology->node_count(),
+        physical_topology_->node_count());
+  }
+  if (!location_constraint) {
+    fprintf(out, "ERROR malformed %s or %s\nEND\n", vn_topology_filename,
+            location_constraint_filename);
+    return;
+  }
+  if (!embedder_.Embed(tenant.virt_topology.get(), location_constraint.get(),
+                       &tenant.embedding)) {
+    fprintf(out, "FAIL %s %s\nEND\n", id.c_str(),
+            tenant.embedding.status.c_str());
+    return;
+  }
+  if (!physical_topology_->ReserveEmbedding(*tenant.virt_topology,
+                                            tenant.embedding)) {
+    fprintf(out, "ERROR not enough bandwidth for the embedding of %s\nEND\n",
+            id.c_str());
+    return;
+  }
+  auto &embedding = tenant.embedding;
+  fprintf(out, "OK %s %s %lf\n", id.c_str(), embedding.status.c_str(),
+          embedding.cost);
+  for (int m = 0; m < embedding.node_map.size(); ++m) {
+    fprintf(out, "node %d %d %d\n", m, embedding.node_map[m],
+            embedding.shadow_node_map[m]);
+  }
+  PrintLinks("link", embedding.edge_map, out);
+  PrintLinks("shadow_link", embedding.shadow_edge_map, out);
+  fprintf(out, "END\n");
+  tenants_[id] = std::move(tenant);
+}
+
+void VNEServer::Release(const std::string &id, FILE *out) {
+  auto it = tenants_.find(id);
+  if (it == tenants_.end()) {
+    fprintf(out, "ERROR %s is not embedded\nEND\n", id.c_str());
+    return;
+  }
+  physical_topology_->ReleaseEmbedding(*it->second.virt_topology,
+                                       it->second.embedding);
+  tenants_.erase(it);
+  fprintf(out, "OK %s\nEND\n", id.c_str());
+}
@@ -0,0 +1,62 @@
+#ifndef VNE_SERVER_H_
+#define VNE_SERVER_H_
+
+#include "datastructure.h"
+#include "vne_embedder.h"
+
+#include <map>
+#include <memory>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Keeps a physical network in memory and embeds virtual networks onto it as
+// requests arrive, without restarting the program or rewriting topology
+// files. Bandwidth of accepted embeddings is reserved in the residual
+// bandwidth of the physical links until the embedding is released.
+//
+// Requests and responses are lines of text:
+//   embed <id> <vn_topology_file> <location_constraint_file>
+//   release <id>
+//   quit
+// A response starts with "OK", "FAIL" (no embedding found) or "ERROR" and is
+// terminated by a line "END". A successful embed is answered with
+//   OK <id> <status> <cost>
+//   node <m> <physical node> <shadow physical node>
+//   link <m> <n> <u>,<v> ...
+//   shadow_link <m> <n> <u>,<v> ...
+// with one node line per virtual node and one link line per virtual link.
+class VNEServer {
+ public:
+  VNEServer(Graph *physical_topology, const EmbeddingOptions &options);
+
+  // Handles requests read from in until the end of the input, a quit
+  // request or a response that cannot be written. Returns false after a
+  // quit request.
+  bool Serve(FILE *in, FILE *out);
+
+  // Accepts clients on a Unix domain socket bound to path and serves them
+  // one at a time until a client sends quit. A socket left at path by an
+  // earlier server is replaced, any other file is not. A client that leaves
+  // before reading its response only ends its own session. Returns false if
+  // the socket cannot be set up or no more clients can be accepted.
+  bool ServeUnixSocket(const char *path);
+
+ private:
+  struct Tenant {
+    std::unique_ptr<Graph> virt_topology;
+    VNEmbedding embedding;
+  };
+
+  void Embed(const std::string &id, const char *vn_topology_filename,
+             const char *location_constraint_filename, FILE *out);
+  void Release(const std::string &id, FILE *out);
+
+  Graph *physical_topology_;
+  EmbeddingOptions options_;
+  VirtualNetworkEmbedder embedder_;
+  // Embedded virtual networks by id.
+  std::map<std::string, Tenant> tenants_;
+};
+
+#endif  // VNE_SERVER_H_
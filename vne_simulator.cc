@@ -0,0 +1,213 @@
+// Discrete event simulator for the arrival and departure of VNs on an SN. It
+// replays the same simulation plans as des.py, but embeds every arriving VN
+// in-process and keeps the residual bandwidth of the SN in memory, so neither
+// a process per event nor rewriting the SN topology file is needed.
+#include "datastructure.h"
+#include "io.h"
+#include "util.h"
+#include "vne_embedder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <unistd.h>
+
+const std::string kUsage = "./vne_simulator "
+                           "--pn_topology_file=<pn_topology_file>\n\t"
+                           "[--vnr_directory=<vnr_directory>]\n\t"
+                           "[--simulation_plan=<simulation_plan_file>]\n\t"
+                           "[--max_simulation_time=<time>]\n\t"
+                           "[--output_file=<output_file>]\n\t"
+                           "[--solver=<ilp|heuristic|path>]\n\t"
+                           "[--backend=<cplex|bnb>]\n\t"
+                           "[--mip_start=<none|heuristic>]\n\t"
+                           "[--formulation=<indicator|aggregated|"
+                           "disaggregated>]\n\t"
+                           "[--lazy_disjointness=<true|false>]\n\t"
+                           "[--symmetry_breaking=<true|false>]\n\t"
+                           "[--export_model=<model_file[.gz]>]\n\t"
+                           "[--reuse_model=<true|false>]\n\t"
+                           "[--build_threads=<threads>]\n\t"
+                           "[MIP parameters, see vne_protection]";
+
+struct SimulationEvent {
+  int ts;
+  bool is_departure;
+  // Index of the VN in the simulation plan.
+  int vn;
+};
+
+// Departures are processed before arrivals at the same time, so that their
+// bandwidth is available to the arriving VNs.
+bool operator<(const SimulationEvent &a, const SimulationEvent &b) {
+  if (a.ts != b.ts) return a.ts < b.ts;
+  if (a.is_departure != b.is_departure) return a.is_departure;
+  return a.vn < b.vn;
+}
+
+struct VirtualNetwork {
+  std::string id;
+  std::unique_ptr<Graph> topology;
+  VNEmbedding embedding;
+  bool is_embedded;
+};
+
+// Writes the utilization of every physical link carrying traffic.
+void WriteUtilization(const Graph &physical_topology, int ts, FILE *outfile) {
+  for (int u = 0; u < physical_topology.node_count(); ++u) {
+    for (auto &end_point : physical_topology.adj_list()->at(u)) {
+      int v = end_point.node_id;
+      if (u > v || end_point.bandwidth <= 0) continue;
+      double utilization =
+          static_cast<double>(end_point.bandwidth -
+                              end_point.residual_bandwidth) /
+          end_point.bandwidth;
+      if (utilization > 0) {
+        fprintf(outfile, "util,%d,%d,%d,%lf\n", ts, u, v, utilization);
+      }
+    }
+  }
+}
+
+int main(int argc, char *argv[]) {
+  using std::string;
+  auto arg_map = ParseArgs(argc, argv);
+  string pn_topology_filename = "";
+  string vnr_directory = "vnr";
+  string simulation_plan_filename = "vnr-simulation";
+  int max_simulation_time = 1000;
+  string output_filename = "sim-results.csv";
+  EmbeddingOptions options;
+  if (!ParseEmbeddingOptions(arg_map.get(), &options)) return 1;
+  for (auto argument : *arg_map) {
+    if (argument.first == "--pn_topology_file") {
+      pn_topology_filename = argument.second;
+    } else if (argument.first == "--vnr_directory") {
+      vnr_directory = argument.second;
+    } else if (argument.first == "--simulation_plan") {
+      simulation_plan_filename = argument.second;
+    } else if (argument.first == "--max_simulation_time") {
+      max_simulation_time = atoi(argument.second.c_str());
+    } else if (argument.first == "--output_file") {
+      output_filename = argument.second;
+    } else {
+      printf("Invalid command line option: %s\n", argument.first.c_str());
+      printf("Usage: %s\n", kUsage.c_str());
+      return 1;
+    }
+  }
+  if (access(pn_topology_filename.c_str(), R_OK) ||
+      access(simulation_plan_filename.c_str(), R_OK)) {
+    printf("Cannot read %s or %s\n", pn_topology_filename.c_str(),
+           simulation_plan_filename.c_str());
+    return 1;
+  }
+  auto physical_topology =
+      InitializeTopologyFromFile(pn_topology_filename.c_str());
+  if (!physical_topology) return 1;
+
+  // Each line of the plan has the format: arrival time, departure time, VN id.
+  std::vector<VirtualNetwork> vns;
+  std::vector<SimulationEvent> events;
+  auto plan = ReadCSVFile(simulation_plan_filename.c_str());
+  if (!plan) return 1;
+  for (auto &row : *plan) {
+    if (row.size() < 3) {
+      printf("Malformed simulation plan entry in %s\n",
+             simulation_plan_filename.c_str());
+      return 1;
+    }
+    int vn = vns.size();
+    vns.push_back(VirtualNetwork());
+    vns.back().id = row[2];
+    vns.back().is_embedded = false;
+    SimulationEvent arrival = {atoi(row[0].c_str()), false, vn};
+    events.push_back(arrival);
+    int end_time = atoi(row[1].c_str());
+    if (end_time <= max_simulation_time) {
+      SimulationEvent departure = {end_time, true, vn};
+      events.push_back(departure);
+    }
+  }
+  std::sort(events.begin(), events.end());
+
+  FILE *outfile = fopen(output_filename.c_str(), "w");
+  if (!outfile) {
+    printf("Cannot write %s\n", output_filename.c_str());
+    return 1;
+  }
+  fprintf(outfile, "# event,ts,type,vn_id,status,total_vns,accepted_vns,"
+                   "acceptance_ratio\n");
+  fprintf(outfile, "# util,ts,u,v,utilization\n");
+  int total_vns = 0, accepted_vns = 0;
+  // Time spent in the embedder, i.e., building the models and solving them.
+  double embed_time = 0.0;
+  VirtualNetworkEmbedder embedder(options, physical_topology.get());
+  auto start_time = std::chrono::steady_clock::now();
+  for (auto &event : events) {
+    auto &vn = vns[event.vn];
+    const char *type = event.is_departure ? "departure" : "arrival";
+    printf("ts = %d, etype = %s, vn_id = %s\n", event.ts, type, vn.id.c_str());
+    bool capacity_changed = false;
+    if (event.is_departure) {
+      if (vn.is_embedded) {
+        physical_topology->ReleaseEmbedding(*vn.topology, vn.embedding);
+        vn.is_embedded = false;
+        capacity_changed = true;
+      }
+    } else {
+      ++total_vns;
+      string vn_topology_filename = vnr_directory + "/" + vn.id;
+      string location_constraint_filename = vn_topology_filename + "loc";
+      if (access(vn_topology_filename.c_str(), R_OK) ||
+          access(location_constraint_filename.c_str(), R_OK)) {
+        printf("Cannot read %s or %s\n", vn_topology_filename.c_str(),
+               location_constraint_filename.c_str());
+        return 1;
+      }
+      vn.topology = InitializeTopologyFromFile(vn_topology_filename.c_str());
+      if (!vn.topology) return 1;
+      auto location_constraint = InitializeVNLocationsFromFile(
+          location_constraint_filename.c_str(), vn.topology->node_count(),
+          physical_topology->node_count());
+      if (!location_constraint) return 1;
+      auto embed_start_time = std::chrono::steady_clock::now();
+      bool is_embedded = embedder.Embed(
+          vn.topology.get(), location_constraint.get(), &vn.embedding);
+      std::chrono::duration<double> vn_embed_time =
+          std::chrono::steady_clock::now() - embed_start_time;
+      embed_time += vn_embed_time.count();
+      if (is_embedded &&
+          physical_topology->ReserveEmbedding(*vn.topology, vn.embedding)) {
+        vn.is_embedded = true;
+        capacity_changed = true;
+        ++accepted_vns;
+      }
+    }
+    fprintf(outfile, "event,%d,%s,%s,%s,%d,%d,%lf\n", event.ts, type,
+            vn.id.c_str(), vn.embedding.status.c_str(), total_vns,
+            accepted_vns,
+            total_vns > 0 ? static_cast<double>(accepted_vns) / total_vns
+                          : 0.0);
+    if (capacity_changed) {
+      WriteUtilization(*physical_topology, event.ts, outfile);
+    }
+    fflush(outfile);
+  }
+  fclose(outfile);
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start_time;
+  printf("total = %d, accepted = %d, simulated %d events in %.3lf s\n",
+         total_vns, accepted_vns, static_cast<int>(events.size()),
+         elapsed.count());
+  if (total_vns > 0) {
+    printf("%d VNs embedded in %.3lf s, %.3lf ms per VN end to end\n",
+           total_vns, embed_time, embed_time * 1e3 / total_vns);
+  }
+  if (embedder.model_count() > 0) {
+    printf("%d models built in %.3lf s, %.3lf ms per VN (%s)\n",
+           embedder.model_count(), embedder.build_time(),
+           embedder.build_time() * 1e3 / embedder.model_count(),
+           options.reuse_model ? "reused" : "rebuilt");
+  }
+  return 0;
+}
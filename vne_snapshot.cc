@@ -0,0 +1,74 @@
+// Converts topologies and embeddings between their text formats and binary
+// snapshots (see snapshot.h).
+#include "datastructure.h"
+#include "io.h"
+#include "snapshot.h"
+
+#include <chrono>
+
+const std::string kUsage = "./vne_snapshot "
+                           "--topology_file=<csv_or_snapshot>|"
+                           "--embedding=<snapshot_or_prefix>\n\t"
+                           "--output=<file_or_prefix>\n\t"
+                           "[--format=<binary|text>]";
+
+int main(int argc, char *argv[]) {
+  auto arg_map = ParseArgs(argc, argv);
+  std::string topology_filename = "", embedding = "", output = "";
+  std::string format = "binary";
+  for (auto argument : *arg_map) {
+    if (argument.first == "--topology_file") {
+      topology_filename = argument.second;
+    } else if (argument.first == "--embedding") {
+      embedding = argument.second;
+    } else if (argument.first == "--output") {
+      output = argument.second;
+    } else if (argument.first == "--format") {
+      format = argument.second;
+    } else {
+      printf("Unknown option %s\n%s\n", argument.first.c_str(),
+             kUsage.c_str());
+      return 1;
+    }
+  }
+  if (topology_filename.empty() == embedding.empty() || output.empty() ||
+      (format != "binary" && format != "text")) {
+    printf("%s\n", kUsage.c_str());
+    return 1;
+  }
+
+  if (!topology_filename.empty()) {
+    auto start_time = std::chrono::steady_clock::now();
+    auto graph = InitializeTopologyFromFile(topology_filename.c_str());
+    std::chrono::duration<double> load_time =
+        std::chrono::steady_clock::now() - start_time;
+    if (!graph) return 1;
+    printf("Read %d nodes, %d links in %.3lf ms\n", graph->node_count(),
+           graph->edge_count(), load_time.count() * 1e3);
+    bool is_success =
+        format == "binary" ? WriteGraphSnapshot(*graph, output.c_str())
+                           : WriteTopologyCSV(*graph, output.c_str());
+    if (!is_success) {
+      printf("Cannot write %s\n", output.c_str());
+      return 1;
+    }
+    return 0;
+  }
+
+  // An embedding is either a snapshot file or the common prefix of the text
+  // files written by vne_protection, i.e., the virtual topology file name.
+  VNEmbedding vn_embedding;
+  if (!ReadEmbeddingSnapshot(embedding.c_str(), &vn_embedding) &&
+      !ReadEmbeddingText(embedding, &vn_embedding)) {
+    printf("Cannot read the embedding %s\n", embedding.c_str());
+    return 1;
+  }
+  bool is_success =
+      format == "binary" ? WriteEmbeddingSnapshot(vn_embedding, output.c_str())
+                         : WriteEmbeddingText(vn_embedding, output);
+  if (!is_success) {
+    printf("Cannot write %s\n", output.c_str());
+    return 1;
+  }
+  return 0;
+}
@@ -1,125 +1,273 @@
 #include "vne_solution_builder.h"
+#include "snapshot.h"
 #include "util.h"
 
+#include <algorithm>
 #include <math.h>
+#include <set>
+#include <stdio.h>
+#include <unordered_map>
 
-void VNESolutionBuilder::PrintWorkingEdgeMapping(const char *filename) {
-  FILE *outfile = NULL;
-  if (filename) outfile = fopen(filename, "w");
-  auto &cplex = vne_solver_ptr_->cplex();
-  auto &x_mn_uv = vne_solver_ptr_->x_mn_uv();
-  for (int m = 0; m < virt_topology_->node_count(); ++m) {
-    auto &m_neighbors = virt_topology_->adj_list()->at(m);
-    for (auto &vend_point : m_neighbors) {
-      int n = vend_point.node_id;
-      if (m < n) continue;
-      for (int u = 0; u < physical_topology_->node_count(); ++u) {
-        auto &u_neighbors = physical_topology_->adj_list()->at(u);
-        for (auto &end_point : u_neighbors) {
-          int v = end_point.node_id;
-          if (fabs(cplex.getValue(x_mn_uv[m][n][u][v]) - 1) < EPS) {
-            printf("Virtual edge (%d, %d) --> physical edge (%d, %d)\n", m, n,
-                   u, v);
-            if (outfile) {
-              fprintf(outfile,
-                      "Virtual edge (%d, %d) --> physical edge (%d, %d)\n", m,
-                      n, u, v);
-            }
-          }
-        }
-      }
+namespace {
+// The links mapped to virtual link (m, n) in edge_map, which may be none.
+const std::vector<std::pair<int, int> > &GetPath(
+    const VNEmbedding::EdgeMap &edge_map, const std::pair<int, int> &mn) {
+  static const std::vector<std::pair<int, int> > kNoPath;
+  auto it = edge_map.find(mn);
+  return it == edge_map.end() ? kNoPath : it->second;
+}
+
+// Orders *path, the physical links carrying the flow of a virtual link, into
+// a walk from source to destination with Hierholzer's algorithm, in time
+// linear in the number of links. Flow on cycles that do not touch the walk,
+// which optimal solutions only have on links of cost 0, is kept at the end.
+void OrderPath(int source, std::vector<std::pair<int, int> > *path) {
+  std::unordered_map<int, std::vector<int> > outgoing;
+  for (int i = path->size() - 1; i >= 0; --i) {
+    outgoing[path->at(i).first].push_back(i);
+  }
+  // Pairs of a node and the link it was reached by.
+  std::vector<std::pair<int, int> > stack(1, std::make_pair(source, NIL));
+  std::vector<int> walk;
+  while (!stack.empty()) {
+    auto it = outgoing.find(stack.back().first);
+    if (it != outgoing.end() && !it->second.empty()) {
+      int link = it->second.back();
+      it->second.pop_back();
+      stack.push_back(std::make_pair(path->at(link).second, link));
+    } else {
+      if (stack.back().second != NIL) walk.push_back(stack.back().second);
+      stack.pop_back();
+    }
+  }
+  std::reverse(walk.begin(), walk.end());
+  std::vector<bool> is_on_walk(path->size(), false);
+  std::vector<std::pair<int, int> > ordered;
+  for (int link : walk) {
+    is_on_walk[link] = true;
+    ordered.push_back(path->at(link));
+  }
+  for (int i = 0; i < path->size(); ++i) {
+    if (!is_on_walk[i]) ordered.push_back(path->at(i));
+  }
+  path->swap(ordered);
+}
+}  // namespace
+
+bool ParseSolutionFormat(const std::string &name, SolutionFormat *format) {
+  if (name == "text") {
+    *format = kTextSolution;
+  } else if (name == "json") {
+    *format = kJSONSolution;
+  } else if (name == "binary") {
+    *format = kBinarySolution;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+VNESolutionBuilder::VNESolutionBuilder(VNEProtectionSolver *vne_solver_ptr,
+                                       Graph *physical_topology,
+                                       Graph *virt_topology)
+    : physical_topology_(physical_topology), virt_topology_(virt_topology) {
+  embedding_.status = vne_solver_ptr->backend()->GetStatus();
+  if (embedding_.status == "Optimal" || embedding_.status == "Feasible") {
+    ExtractEmbedding(vne_solver_ptr);
+    OrderPaths();
+  }
+}
+
+VNESolutionBuilder::VNESolutionBuilder(const VNEmbedding &embedding,
+                                       Graph *physical_topology,
+                                       Graph *virt_topology)
+    : embedding_(embedding),
+      physical_topology_(physical_topology),
+      virt_topology_(virt_topology) {
+  if (!embedding_.node_map.empty()) OrderPaths();
+}
+
+void VNESolutionBuilder::OrderPaths() {
+  for (auto &entry : embedding_.edge_map) {
+    OrderPath(embedding_.node_map[entry.first.first], &entry.second);
+  }
+  for (auto &entry : embedding_.shadow_edge_map) {
+    OrderPath(embedding_.shadow_node_map[entry.first.first], &entry.second);
+  }
+}
+
+PathMetrics VNESolutionBuilder::GetPathMetrics(
+    const std::vector<std::pair<int, int> > &path) const {
+  PathMetrics metrics = {static_cast<int>(path.size()), 0, NIL};
+  for (auto &link : path) {
+    auto &end_point = physical_topology_->adj_list()->at(link.first)
+        [physical_topology_->edge_index(link.first, link.second)];
+    metrics.delay += end_point.delay;
+    if (metrics.bottleneck_bandwidth == NIL ||
+        end_point.residual_bandwidth < metrics.bottleneck_bandwidth) {
+      metrics.bottleneck_bandwidth = end_point.residual_bandwidth;
     }
   }
-  if (outfile) fclose(outfile);
+  return metrics;
 }
 
-void VNESolutionBuilder::PrintShadowEdgeMapping(const char *filename) {
-  FILE *outfile = NULL;
-  if (filename) outfile = fopen(filename, "w");
-  auto &cplex = vne_solver_ptr_->cplex();
-  auto &x_mn_uv = vne_solver_ptr_->x_mn_uv();
+void VNESolutionBuilder::ExtractEmbedding(VNEProtectionSolver *vne_solver_ptr) {
+  auto *backend = vne_solver_ptr->backend();
+  std::vector<double> values;
+  backend->GetValues(&values);
+  // Variables removed by presolve are 0.
+  auto is_one = [&values](int variable) {
+    return variable != NIL && fabs(values[variable] - 1) < EPS;
+  };
+  // The objective of a batch covers all of its virtual networks.
+  int admit = vne_solver_ptr->admit_variable();
+  if (admit == NIL) {
+    embedding_.cost = backend->GetObjValue();
+  } else if (!is_one(admit)) {
+    embedding_.status = "Rejected";
+    return;
+  } else {
+    embedding_.cost = vne_solver_ptr->objective().constant;
+    for (auto &term : vne_solver_ptr->objective().terms) {
+      embedding_.cost += term.second * values[term.first];
+    }
+  }
   int offset = virt_topology_->node_count();
+  embedding_.node_map.assign(virt_topology_->node_count(), NIL);
+  embedding_.shadow_node_map.assign(virt_topology_->node_count(), NIL);
+  for (int m = 0; m < virt_topology_->node_count(); ++m) {
+    for (int u = 0; u < physical_topology_->node_count(); ++u) {
+      if (is_one(vne_solver_ptr->y_m_u(m, u))) embedding_.node_map[m] = u;
+      if (is_one(vne_solver_ptr->y_m_u(m + offset, u))) {
+        embedding_.shadow_node_map[m] = u;
+      }
+    }
+  }
+  int next_mn = 0;
+  auto &pn = vne_solver_ptr->physical_graph();
   for (int m = 0; m < virt_topology_->node_count(); ++m) {
     auto &m_neighbors = virt_topology_->adj_list()->at(m);
     for (auto &vend_point : m_neighbors) {
       int n = vend_point.node_id;
+      int mn = next_mn++;
       if (m < n) continue;
-      for (int u = 0; u < physical_topology_->node_count(); ++u) {
-        auto &u_neighbors = physical_topology_->adj_list()->at(u);
-        for (auto &end_point : u_neighbors) {
-          int v = end_point.node_id;
-          if (fabs(cplex.getValue(x_mn_uv[m + offset][n + offset][u][v]) - 1) <
-              EPS) {
-            printf(
-                "Shadow virtual edge of (%d, %d) --> physical edge (%d, %d)\n",
-                m, n, u, v);
-            if (outfile) {
-              fprintf(outfile, "Shadow virtual edge of (%d, %d) --> physical "
-                               "edge (%d, %d)\n",
-                      m, n, u, v);
-            }
-          }
+      int shadow_mn = mn + vne_solver_ptr->vn_edge_count();
+      auto &links = embedding_.edge_map[std::make_pair(m, n)];
+      auto &shadow_links = embedding_.shadow_edge_map[std::make_pair(m, n)];
+      for (int uv = 0; uv < pn.edge_count(); ++uv) {
+        int u = pn.tail(uv), v = pn.head(uv);
+        if (is_one(vne_solver_ptr->x(mn, uv))) {
+          links.push_back(std::make_pair(u, v));
         }
-      }
-    }
-  }
-  if (outfile) fclose(outfile);
-}
-
-void VNESolutionBuilder::PrintWorkingNodeMapping(const char *filename) {
-  FILE *outfile = NULL;
-  if (filename) outfile = fopen(filename, "w");
-  auto &cplex = vne_solver_ptr_->cplex();
-  auto &y_m_u = vne_solver_ptr_->y_m_u();
-  for (int m = 0; m < virt_topology_->node_count(); ++m) {
-    for (int u = 0; u < physical_topology_->node_count(); ++u) {
-      if (fabs(cplex.getValue(y_m_u[m][u]) - 1) < EPS) {
-        printf("Virtual node %d --> physical node %d\n", m, u);
-        if (outfile) {
-          fprintf(outfile, "Virtual node %d --> physical node %d\n", m, u);
+        if (is_one(vne_solver_ptr->x(shadow_mn, uv))) {
+          shadow_links.push_back(std::make_pair(u, v));
         }
       }
     }
   }
-  if (outfile) fclose(outfile);
 }
 
-void VNESolutionBuilder::PrintShadowNodeMapping(const char *filename) {
-  FILE *outfile = NULL;
-  if (filename) outfile = fopen(filename, "w");
-  auto &cplex = vne_solver_ptr_->cplex();
-  auto &y_m_u = vne_solver_ptr_->y_m_u();
-  int offset = virt_topology_->node_count();
-  for (int m = 0; m < virt_topology_->node_count(); ++m) {
-    for (int u = 0; u < physical_topology_->node_count(); ++u) {
-      if (fabs(cplex.getValue(y_m_u[m + offset][u]) - 1) < EPS) {
-        printf("Shadow virtual node of %d --> physical node %d\n", m, u);
-        if (outfile) {
-          fprintf(outfile, "Shadow virtual node of %d --> physical node %d\n",
-                  m, u);
-        }
-      }
+void VNESolutionBuilder::PrintSolution(bool print_mapping) {
+  printf("Solution status = %s\n", embedding_.status.c_str());
+  if (embedding_.node_map.empty()) return;
+  printf("Cost = %lf\n", embedding_.cost);
+  if (!print_mapping) return;
+  for (int m = 0; m < embedding_.node_map.size(); ++m) {
+    printf("Virtual node %d --> physical node %d\n", m,
+           embedding_.node_map[m]);
+    printf("Shadow virtual node of %d --> physical node %d\n", m,
+           embedding_.shadow_node_map[m]);
+  }
+  for (auto &entry : embedding_.edge_map) {
+    int m = entry.first.first, n = entry.first.second;
+    for (auto &link : entry.second) {
+      printf("Virtual edge (%d, %d) --> physical edge (%d, %d)\n", m, n,
+             link.first, link.second);
+    }
+    auto &shadow_path = GetPath(embedding_.shadow_edge_map, entry.first);
+    for (auto &link : shadow_path) {
+      printf("Shadow virtual edge of (%d, %d) --> physical edge (%d, %d)\n",
+             m, n, link.first, link.second);
     }
+    PathMetrics metrics = GetPathMetrics(entry.second);
+    PathMetrics shadow_metrics = GetPathMetrics(shadow_path);
+    printf("Virtual edge (%d, %d): %d hops, delay %ld, bottleneck %ld; "
+           "shadow %d hops, delay %ld, bottleneck %ld\n",
+           m, n, metrics.hops, metrics.delay, metrics.bottleneck_bandwidth,
+           shadow_metrics.hops, shadow_metrics.delay,
+           shadow_metrics.bottleneck_bandwidth);
   }
-  if (outfile) fclose(outfile);
 }
 
-void VNESolutionBuilder::PrintSolutionStatus(const char *filename) {
-  auto &cplex = vne_solver_ptr_->cplex();
-  std::cout << "Solution status = " << cplex.getStatus() << std::endl;
-  if (filename) {
-    std::ofstream ofs(filename);
-    ofs << cplex.getStatus();
-    ofs.close();
+bool VNESolutionBuilder::WriteSolution(SolutionFormat format,
+                                       const std::string &prefix) {
+  switch (format) {
+    case kTextSolution:
+      return WriteEmbeddingText(embedding_, prefix);
+    case kJSONSolution:
+      return WriteJSON((prefix + ".json").c_str());
+    case kBinarySolution:
+      return WriteEmbeddingSnapshot(embedding_, (prefix + ".emb").c_str());
   }
+  return false;
 }
 
-void VNESolutionBuilder::PrintCost(const char *filename) {
-  FILE *outfile = NULL;
-  if (filename) outfile = fopen(filename, "w");
-  auto &cplex = vne_solver_ptr_->cplex();
-  printf("Cost = %lf\n", cplex.getObjValue());
-  if (outfile) {
-    fprintf(outfile, "%lf\n", cplex.getObjValue());
+// {"status": ..., "cost": ..., "node_map": [...], "shadow_node_map": [...],
+//  "links": [{"m": ..., "n": ..., "path": [[u, v], ...], "delay": ...,
+//             "bottleneck_bandwidth": ..., "shadow_path": [[u, v], ...],
+//             "shadow_delay": ..., "shadow_bottleneck_bandwidth": ...}, ...]}
+// without the cost and the mappings if no embedding has been found.
+bool VNESolutionBuilder::WriteJSON(const char *filename) {
+  FILE *outfile = fopen(filename, "w");
+  if (!outfile) return false;
+  fprintf(outfile, "{\"status\": \"");
+  for (char c : embedding_.status) {
+    if (c == '"' || c == '\\') fputc('\\', outfile);
+    fputc(c, outfile);
+  }
+  fprintf(outfile, "\"");
+  auto print_path = [this, outfile](
+      const char *prefix, const std::vector<std::pair<int, int> > &path) {
+    fprintf(outfile, "\"%spath\": [", prefix);
+    for (int i = 0; i < path.size(); ++i) {
+      fprintf(outfile, "%s[%d, %d]", i > 0 ? ", " : "", path[i].first,
+              path[i].second);
+    }
+    PathMetrics metrics = GetPathMetrics(path);
+    fprintf(outfile, "], \"%sdelay\": %ld, \"%sbottleneck_bandwidth\": ",
+            prefix, metrics.delay, prefix);
+    if (metrics.bottleneck_bandwidth == NIL) {
+      fprintf(outfile, "null");
+    } else {
+      fprintf(outfile, "%ld", metrics.bottleneck_bandwidth);
+    }
+  };
+  if (!embedding_.node_map.empty()) {
+    fprintf(outfile, ", \"cost\": %lf", embedding_.cost);
+    for (int is_shadow = 0; is_shadow < 2; ++is_shadow) {
+      auto &node_map = is_shadow ? embedding_.shadow_node_map
+                                 : embedding_.node_map;
+      fprintf(outfile, ", \"%s\": [",
+              is_shadow ? "shadow_node_map" : "node_map");
+      for (int m = 0; m < node_map.size(); ++m) {
+        fprintf(outfile, "%s%d", m > 0 ? ", " : "", node_map[m]);
+      }
+      fprintf(outfile, "]");
+    }
+    std::set<std::pair<int, int> > vlinks;
+    for (auto &entry : embedding_.edge_map) vlinks.insert(entry.first);
+    for (auto &entry : embedding_.shadow_edge_map) vlinks.insert(entry.first);
+    fprintf(outfile, ", \"links\": [");
+    for (auto it = vlinks.begin(); it != vlinks.end(); ++it) {
+      fprintf(outfile, "%s{\"m\": %d, \"n\": %d, ",
+              it != vlinks.begin() ? ", " : "", it->first, it->second);
+      print_path("", GetPath(embedding_.edge_map, *it));
+      fprintf(outfile, ", ");
+      print_path("shadow_", GetPath(embedding_.shadow_edge_map, *it));
+      fprintf(outfile, "}");
+    }
+    fprintf(outfile, "]");
   }
+  fprintf(outfile, "}\n");
+  return fclose(outfile) == 0;
 }
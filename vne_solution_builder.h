@@ -1,25 +1,62 @@
 #ifndef VNE_SOLUTION_BUILDER_H_
 #define VNE_SOLUTION_BUILDER_H_
 
-#include "cplex_solver.h"
+#include "datastructure.h"
+#include "vne_protection_solver.h"
+
+#include <string>
+
+// Formats the solution files are written in:
+//   kTextSolution: <prefix>.status, .cost, .nmap, .snmap, .emap and .semap.
+//   kJSONSolution: <prefix>.json, the embedding as a single JSON line.
+//   kBinarySolution: <prefix>.emb, a binary snapshot (see snapshot.h).
+enum SolutionFormat { kTextSolution, kJSONSolution, kBinarySolution };
+
+// Parses "text", "json" or "binary". Returns false for any other name.
+bool ParseSolutionFormat(const std::string &name, SolutionFormat *format);
+
+// Length, total delay and bottleneck bandwidth, i.e., the smallest residual
+// bandwidth before the embedding, of a path of physical links. The bottleneck
+// of an empty path is NIL.
+struct PathMetrics {
+  int hops;
+  long delay;
+  long bottleneck_bandwidth;
+};
 
 class VNESolutionBuilder {
  public:
-  VNESolutionBuilder(VNEProtectionCPLEXSolver *vne_solver_ptr,
-                     Graph *physical_topology, Graph *virt_topology)
-      : vne_solver_ptr_(vne_solver_ptr),
-        physical_topology_(physical_topology),
-        virt_topology_(virt_topology) {}
-
-  void PrintWorkingEdgeMapping(const char *filename);
-  void PrintShadowEdgeMapping(const char *filename);
-  void PrintWorkingNodeMapping(const char *filename);
-  void PrintShadowNodeMapping(const char *filename);
-  void PrintSolutionStatus(const char *filename);
-  void PrintCost(const char *filename);
+  // Builds the solution from the values of the model variables. The mapping
+  // is only extracted if the backend has found a solution; a virtual network
+  // that a VNEProtectionBatchSolver rejects gets the status "Rejected". Both
+  // constructors order the links of every path from the host of m to the host
+  // of n for virtual link (m, n).
+  VNESolutionBuilder(VNEProtectionSolver *vne_solver_ptr,
+                     Graph *physical_topology, Graph *virt_topology);
+  // Uses an embedding computed without the ILP model, e.g., by
+  // VNEProtectionHeuristicSolver.
+  VNESolutionBuilder(const VNEmbedding &embedding, Graph *physical_topology,
+                     Graph *virt_topology);
+
+  const VNEmbedding &embedding() const { return embedding_; }
+
+  PathMetrics GetPathMetrics(
+      const std::vector<std::pair<int, int> > &path) const;
+
+  // Prints the status and the cost and, if print_mapping is set, the node and
+  // link mappings to the standard output.
+  void PrintSolution(bool print_mapping);
+
+  // Writes the embedding to the file(s) named prefix + the extension(s) of
+  // format. Returns false if a file cannot be written.
+  bool WriteSolution(SolutionFormat format, const std::string &prefix);
 
  private:
-  VNEProtectionCPLEXSolver *vne_solver_ptr_;
+  void ExtractEmbedding(VNEProtectionSolver *vne_solver_ptr);
+  void OrderPaths();
+  bool WriteJSON(const char *filename);
+
+  VNEmbedding embedding_;
   Graph *physical_topology_;
   Graph *virt_topology_;
 };